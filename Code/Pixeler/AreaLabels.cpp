@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <array>
+
+#include "AreaLabels.h"
+#include "PixelStore.h"
+
+
+namespace Pixeler
+{
+	// The directions the sides of a pixel are walked along when tracing a contour, with the pixel on the right: its top, right, bottom and left sides.
+	static const std::array< sf::Vector2i, 4 > Side_Directions{ { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } } };
+	static const std::array< sf::Vector2i, 4 > Side_Ends{ { { 1, 0 }, { 1, 1 }, { 0, 1 }, { 0, 0 } } };		// The end of each side, from the top left corner of the pixel.
+	static constexpr uint8_t Nb_Sides{ 4 };
+
+	/**
+	* @brief Label the areas of the converted image, from the palette indices of its pixels.
+	* @param [in] _pixels The pixels of the image.
+	**/
+	void AreaLabels::compute( const PixelStore& _pixels )
+	{
+		clear();
+
+		const std::span< const uint16_t > palette_indices{ _pixels.get_palette_indices() };
+		const sf::Vector2u& image_size{ _pixels.get_size() };
+
+		m_size = image_size;
+		m_pixel_areas.resize( palette_indices.size() );
+
+		auto find_root = [&]( uint32_t _label )
+		{
+			uint32_t root{ _label };
+
+			while( m_parents[ root ] != root )
+				root = m_parents[ root ];
+
+			while( m_parents[ _label ] != root )
+			{
+				const uint32_t parent{ m_parents[ _label ] };
+				m_parents[ _label ] = root;
+				_label = parent;
+			}
+
+			return root;
+		};
+
+		// First pass: each pixel takes the provisional label of its left or top neighbor of the same color, or a new one if it has none.
+		// When both neighbors have the same color but different labels, their trees are merged. A label is always linked to a smaller one, so the root of a tree is its first label.
+		for( uint32_t row{ 0 }; row < image_size.y; ++row )
+		{
+			const size_t first_pixel{ static_cast< size_t >( row ) * image_size.x };
+
+			for( uint32_t column{ 0 }; column < image_size.x; ++column )
+			{
+				const size_t pixel{ first_pixel + column };
+				const uint16_t palette_index{ palette_indices[ pixel ] };
+
+				if( palette_index == PixelStore::Invalid_Index )
+				{
+					m_pixel_areas[ pixel ] = Invalid_Area;
+					continue;
+				}
+
+				const bool same_as_left{ column > 0 && palette_indices[ pixel - 1 ] == palette_index };
+				const bool same_as_top{ row > 0 && palette_indices[ pixel - image_size.x ] == palette_index };
+
+				if( same_as_left && same_as_top )
+				{
+					const uint32_t left_label{ m_pixel_areas[ pixel - 1 ] };
+					const uint32_t top_label{ m_pixel_areas[ pixel - image_size.x ] };
+
+					// If the top left pixel has the same color too, both neighbors are already in the same tree.
+					if( left_label != top_label && palette_indices[ pixel - image_size.x - 1 ] != palette_index )
+					{
+						const uint32_t left_root{ find_root( left_label ) };
+						const uint32_t top_root{ find_root( top_label ) };
+
+						m_parents[ std::max( left_root, top_root ) ] = std::min( left_root, top_root );
+					}
+
+					m_pixel_areas[ pixel ] = left_label;
+				}
+				else if( same_as_left )
+					m_pixel_areas[ pixel ] = m_pixel_areas[ pixel - 1 ];
+				else if( same_as_top )
+					m_pixel_areas[ pixel ] = m_pixel_areas[ pixel - image_size.x ];
+				else
+				{
+					m_pixel_areas[ pixel ] = static_cast< uint32_t >( m_parents.size() );
+					m_parents.push_back( m_pixel_areas[ pixel ] );
+				}
+			}
+		}
+
+		// Each root becomes an area, in the order of the labels, which is the order of the first pixels of the areas.
+		// A label is always bigger than its parent, so the parent has already been replaced by its area.
+		for( uint32_t label{ 0 }; label < m_parents.size(); ++label )
+		{
+			if( m_parents[ label ] == label )
+			{
+				m_parents[ label ] = static_cast< uint32_t >( m_areas.size() );
+				m_areas.push_back( {} );
+			}
+			else
+				m_parents[ label ] = m_parents[ m_parents[ label ] ];
+		}
+
+		// Second pass: the pixels take the label of their area.
+		size_t nb_area_pixels{ 0 };
+
+		for( size_t pixel{ 0 }; pixel < m_pixel_areas.size(); ++pixel )
+		{
+			if( m_pixel_areas[ pixel ] == Invalid_Area )
+				continue;
+
+			Area& area{ m_areas[ m_parents[ m_pixel_areas[ pixel ] ] ] };
+
+			if( area.m_nb_pixels == 0 )
+				area.m_palette_index = palette_indices[ pixel ];
+
+			++area.m_nb_pixels;
+			++nb_area_pixels;
+			m_pixel_areas[ pixel ] = m_parents[ m_pixel_areas[ pixel ] ];
+		}
+
+		// The pixels of each area are gathered together, the parents are reused as the position of the next pixel of each area.
+		uint32_t first_pixel{ 0 };
+
+		for( uint32_t area{ 0 }; area < m_areas.size(); ++area )
+		{
+			m_areas[ area ].m_first_pixel = first_pixel;
+			m_parents[ area ] = first_pixel;
+			first_pixel += m_areas[ area ].m_nb_pixels;
+		}
+
+		m_area_pixels.resize( nb_area_pixels );
+
+		for( uint32_t pixel{ 0 }; pixel < m_pixel_areas.size(); ++pixel )
+		{
+			if( m_pixel_areas[ pixel ] != Invalid_Area )
+				m_area_pixels[ m_parents[ m_pixel_areas[ pixel ] ]++ ] = pixel;
+		}
+
+		// The areas are also grouped by color, the same way.
+		uint16_t nb_colors{ 0 };
+
+		for( const Area& area : m_areas )
+			nb_colors = std::max< uint16_t >( nb_colors, area.m_palette_index + 1 );
+
+		m_color_first_areas.assign( nb_colors + 1, 0 );
+
+		for( const Area& area : m_areas )
+			++m_color_first_areas[ area.m_palette_index + 1 ];
+
+		for( uint16_t color{ 0 }; color < nb_colors; ++color )
+			m_color_first_areas[ color + 1 ] += m_color_first_areas[ color ];
+
+		m_parents.assign( m_color_first_areas.begin(), m_color_first_areas.end() - 1 );
+		m_color_areas.resize( m_areas.size() );
+
+		for( uint32_t area{ 0 }; area < m_areas.size(); ++area )
+			m_color_areas[ m_parents[ m_areas[ area ].m_palette_index ]++ ] = area;
+	}
+
+	/**
+	* @brief Get the areas of a palette color, so hovering a color doesn't have to look for them.
+	* @param [in] _palette_index The index of the color in the palette colors vector.
+	* @return The labels of the areas, in the order of their first pixel. Empty if no pixel has the color.
+	**/
+	std::span< const uint32_t > AreaLabels::get_color_areas( uint16_t _palette_index ) const
+	{
+		if( _palette_index + size_t{ 1 } >= m_color_first_areas.size() )
+			return {};
+
+		return std::span{ m_color_areas }.subspan( m_color_first_areas[ _palette_index ], m_color_first_areas[ _palette_index + 1 ] - m_color_first_areas[ _palette_index ] );
+	}
+
+	/**
+	* @brief Trace the contours of an area by following its boundary on the label plane, with the area on the right.
+	* The outer boundary goes clockwise on the screen and the holes counterclockwise. Diagonal pixels aren't connected, so they are kept on separate contours.
+	* @param [in] _area		The label of the area.
+	* @param [out] _contours	The contours of the area.
+	**/
+	void AreaLabels::trace_contours( uint32_t _area, Contours& _contours )
+	{
+		_contours.m_corners.clear();
+		_contours.m_contour_ends.clear();
+
+		if( _area >= m_areas.size() )
+			return;
+
+		if( m_traced_sides.size() != m_pixel_areas.size() )
+			m_traced_sides.assign( m_pixel_areas.size(), 0 );
+
+		auto is_in_area = [&]( const sf::Vector2i& _position )
+		{
+			return _position.x >= 0 && _position.y >= 0 && _position.x < static_cast< int >( m_size.x ) && _position.y < static_cast< int >( m_size.y )
+				&& m_pixel_areas[ static_cast< size_t >( _position.y ) * m_size.x + _position.x ] == _area;
+		};
+
+		const std::span< const uint32_t > area_pixels{ get_area_pixels( _area ) };
+
+		// Each side of a pixel of the area facing another area or the border of the image starts a contour, unless it has already been traced.
+		for( const uint32_t first_pixel : area_pixels )
+		{
+			const sf::Vector2i first_position{ static_cast< int >( first_pixel % m_size.x ), static_cast< int >( first_pixel / m_size.x ) };
+
+			for( uint8_t first_side{ 0 }; first_side < Nb_Sides; ++first_side )
+			{
+				if( ( m_traced_sides[ first_pixel ] >> first_side & 1 ) != 0 || is_in_area( first_position + Side_Directions[ ( first_side + 3 ) % Nb_Sides ] ) )
+					continue;
+
+				sf::Vector2i position{ first_position };
+				uint8_t side{ first_side };
+
+				do
+				{
+					m_traced_sides[ static_cast< size_t >( position.y ) * m_size.x + position.x ] |= 1 << side;
+
+					// The pixels ahead of the side, on both sides of its direction, tell where the boundary goes next.
+					const sf::Vector2i ahead_right{ position + Side_Directions[ side ] };
+					const sf::Vector2i ahead_left{ ahead_right + Side_Directions[ ( side + 3 ) % Nb_Sides ] };
+					const sf::Vector2i side_end{ position + Side_Ends[ side ] };
+					uint8_t next_side{ side };
+
+					if( is_in_area( ahead_right ) == false )
+						next_side = ( side + 1 ) % Nb_Sides;
+					else if( is_in_area( ahead_left ) == false )
+						position = ahead_right;
+					else
+					{
+						next_side = ( side + 3 ) % Nb_Sides;
+						position = ahead_left;
+					}
+
+					// Only the turns are kept, the sides walked in the same direction are merged.
+					if( next_side != side )
+						_contours.m_corners.emplace_back( static_cast< uint32_t >( side_end.x ), static_cast< uint32_t >( side_end.y ) );
+
+					side = next_side;
+				}
+				while( position != first_position || side != first_side );
+
+				_contours.m_contour_ends.push_back( static_cast< uint32_t >( _contours.m_corners.size() ) );
+			}
+		}
+
+		for( const uint32_t pixel : area_pixels )
+			m_traced_sides[ pixel ] = 0;
+	}
+
+	/**
+	* @brief Remove all the areas.
+	**/
+	void AreaLabels::clear()
+	{
+		m_pixel_areas.clear();
+		m_areas.clear();
+		m_area_pixels.clear();
+		m_color_areas.clear();
+		m_color_first_areas.clear();
+		m_traced_sides.clear();
+		m_size = { 0, 0 };
+		m_parents.clear();
+	}
+} // namespace Pixeler
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <SFML/System/Vector2.hpp>
+
+#include "Defines.h"
+
+
+namespace Pixeler
+{
+	class PixelStore;
+
+	/************************************************************************
+	* @brief The areas of the converted image: each group of 4-connected pixels sharing the same palette color is an area, identified by its label.
+	* The areas are found once per conversion with a two-pass union-find labeling, so hovering a pixel only has to look up its label.
+	************************************************************************/
+	class AreaLabels
+	{
+	public:
+		static constexpr uint32_t Invalid_Area{ Uint32_Max };		// The pixel is transparent or hasn't been converted.
+
+		/************************************************************************
+		* @brief An area of the image, its pixels are stored together in the pixels of all the areas.
+		************************************************************************/
+		struct Area
+		{
+			uint16_t m_palette_index{ 0 };						// The index of the color of the area in the palette colors vector.
+			uint32_t m_first_pixel{ 0 };						// The position of the first pixel of the area in m_area_pixels.
+			uint32_t m_nb_pixels{ 0 };
+		};
+
+		/************************************************************************
+		* @brief The closed outlines of an area: its outer boundary and the boundaries of its holes, following the edges of its pixels.
+		* Each contour only keeps its corners, the straight runs of pixel edges between them are merged.
+		************************************************************************/
+		struct Contours
+		{
+			std::vector< sf::Vector2u >	m_corners;					// The corners of all the contours in image space, one contour after the other.
+			std::vector< uint32_t >		m_contour_ends;				// The position in m_corners following the last corner of each contour.
+		};
+
+		/**
+		* @brief Label the areas of the converted image, from the palette indices of its pixels.
+		* @param [in] _pixels The pixels of the image.
+		**/
+		void compute( const PixelStore& _pixels );
+
+		/**
+		* @brief Remove all the areas.
+		**/
+		void clear();
+
+		size_t				get_nb_areas() const { return m_areas.size(); }
+		const Area&			get_area( uint32_t _area ) const { return m_areas[ _area ]; }
+
+		/**
+		* @brief Get the area a pixel belongs to.
+		* @param [in] _pixel The index of the pixel in the image.
+		* @return The label of the area, Invalid_Area if the pixel isn't part of any.
+		**/
+		uint32_t get_pixel_area( size_t _pixel ) const { return _pixel < m_pixel_areas.size() ? m_pixel_areas[ _pixel ] : Invalid_Area; }
+
+		/**
+		* @brief Get the pixels of an area, row by row.
+		* @param [in] _area The label of the area.
+		**/
+		std::span< const uint32_t > get_area_pixels( uint32_t _area ) const { return std::span{ m_area_pixels }.subspan( m_areas[ _area ].m_first_pixel, m_areas[ _area ].m_nb_pixels ); }
+
+		/**
+		* @brief Get the areas of a palette color, so hovering a color doesn't have to look for them.
+		* @param [in] _palette_index The index of the color in the palette colors vector.
+		* @return The labels of the areas, in the order of their first pixel. Empty if no pixel has the color.
+		**/
+		std::span< const uint32_t > get_color_areas( uint16_t _palette_index ) const;
+
+		/**
+		* @brief Trace the contours of an area by following its boundary on the label plane, with the area on the right.
+		* The outer boundary goes clockwise on the screen and the holes counterclockwise. Diagonal pixels aren't connected, so they are kept on separate contours.
+		* @param [in] _area		The label of the area.
+		* @param [out] _contours	The contours of the area.
+		**/
+		void trace_contours( uint32_t _area, Contours& _contours );
+
+	private:
+		std::vector< uint32_t >	m_pixel_areas;							// The label of the area of each pixel, Invalid_Area for the pixels without palette color.
+		std::vector< Area >		m_areas;								// The areas, in the order of their first pixel.
+		std::vector< uint32_t >	m_area_pixels;							// The pixels of all the areas, grouped area by area.
+		std::vector< uint32_t >	m_color_areas;							// The labels of all the areas, grouped by palette color.
+		std::vector< uint32_t >	m_color_first_areas;					// The position of the first area of each palette color in m_color_areas, followed by the number of areas.
+		std::vector< uint8_t >	m_traced_sides;							// One bit per side of each pixel, set for the sides already part of a contour while tracing an area.
+		sf::Vector2u			m_size{ 0, 0 };							// The size of the labeled image.
+		std::vector< uint32_t >	m_parents;								// The union-find forest of the provisional labels of the first pass, kept to avoid an allocation per conversion.
+	};
+} // namespace Pixeler
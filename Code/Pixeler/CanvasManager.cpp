@@ -1,5 +1,11 @@
 //#include <SFML/Graphics.hpp>
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <iterator>
+#include <memory>
+
+#include <SFML/Graphics/RectangleShape.hpp>
 
 #include <FZN/Managers/DataManager.h>
 #include <FZN/Managers/WindowManager.h>
@@ -8,12 +14,20 @@
 #include <FZN/Tools/Logging.h>
 
 #include "CanvasManager.h"
+#include "ImageLoadJob.h"
 #include "Pixeler.h"
 #include "Utils.h"
 
 
 namespace Pixeler
 {
+	static constexpr size_t Min_Pixels_Per_Task{ 65536 };		// Below this number of pixels, updating them on another thread costs more than it saves.
+	static constexpr float Min_Zoom_Level{ 0.01f };				// The smallest size of a pixel on the canvas, reduced levels of the image are drawn below 1.
+	static constexpr float Max_Zoom_Level{ 100.f };				// The biggest size of a pixel on the canvas.
+	static constexpr float Mouse_Wheel_Zoom_Factor{ 1.25f };	// The zoom level is multiplied by this factor for each notch of the mouse wheel.
+	static constexpr float Minimap_Size{ 160.f };				// The size of the biggest side of the minimap on the canvas.
+	static constexpr float Minimap_Margin{ 8.f };				// The space between the minimap and the bottom right corner of the canvas.
+
 	CanvasManager::CanvasManager()
 	{
 		g_pFZN_Core->AddCallback( this, &CanvasManager::on_event, fzn::DataCallbackType::Event );
@@ -29,14 +43,6 @@ namespace Pixeler
 		m_grid_texture.create( window_size.x, window_size.y );
 		m_grid_sprite.setTexture( m_grid_texture.getTexture() );
 
-		m_base_pixels.setPrimitiveType( sf::PrimitiveType::Quads );
-		m_converted_pixels.setPrimitiveType( sf::PrimitiveType::Quads );
-
-		m_offsets[ 0 ] = { 0.f,				0.f };				// top left
-		m_offsets[ 1 ] = { m_zoom_level,	0.f };				// top right
-		m_offsets[ 2 ] = { m_zoom_level,	m_zoom_level };		// bottom right
-		m_offsets[ 3 ] = { 0.f,				m_zoom_level };		// bottom left
-
 		m_hovered_color.m_hovered_area_line.set_thickness( 1.f );
 		m_hovered_color.m_hovered_area_line.set_color( sf::Color::Red );
 
@@ -62,11 +68,31 @@ namespace Pixeler
 			m_render_texture.create( window_event.size.width, window_event.size.height );
 			m_grid_texture.create( window_event.size.width, window_event.size.height );
 			m_test_texture.create( window_event.size.width, window_event.size.height );
+			m_canvas_outdated = true;
 		}
 	}
 
 	void CanvasManager::update()
 	{
+		std::erase_if( m_cancelled_load_jobs, []( const std::unique_ptr< ImageLoadJob >& _job ) { return _job->is_finished(); } );
+
+		// The loaded image is swapped in at the beginning of the frame, so the whole frame uses the same one.
+		if( m_load_job != nullptr && m_load_job->is_finished() )
+		{
+			if( std::unique_ptr< ImageLoadJob::Result > result{ m_load_job->take_result() } )
+				_apply_loaded_image( *result );
+			else
+				FZN_COLOR_LOG( fzn::DBG_MSG_COL_RED, "Failure : %s couldn't be loaded", m_load_job->get_path().c_str() );
+
+			m_load_job.reset();
+		}
+
+		// The conversion follows the modifications of its palette right away. Selecting or unselecting colors only picks other candidates for the distinct colors.
+		const std::shared_ptr< const ConversionResult > conversion_result{ g_pixeler->get_palettes_manager().get_conversion_result() };
+
+		if( conversion_result != nullptr && g_pixeler->get_palettes_manager().is_conversion_outdated( *conversion_result ) )
+			_convert_image_colors();
+
 		auto& options_datas{ g_pixeler->get_options().get_options_datas() };
 		auto& canvas_bg_color{ options_datas.m_canvas_background_color };
 		ImGui::PushStyleColor( ImGuiCol_ChildBg, canvas_bg_color );
@@ -90,119 +116,110 @@ namespace Pixeler
 		
 	}
 
-	void CanvasManager::load_texture( std::string_view _path )
+	/**
+	* @brief Start loading an image on a worker thread, cancelling the one being loaded. The image is decoded on the CPU and replaces the displayed one once it is entirely loaded.
+	* @param _path The path of the image.
+	**/
+	void CanvasManager::load_image( std::string_view _path )
 	{
 		if( _path.empty() )
 			return;
 
-		if( g_pFZN_DataMgr->GetTexture( "Perler Default Image", false ) != nullptr )
-			g_pFZN_DataMgr->UnloadTexture( "Perler Default Image" );
-
-		auto texture = g_pFZN_DataMgr->LoadTexture( "Perler Default Image", _path.data() );
-
-		if( texture != nullptr )
-			m_default_image_sprite.setTexture( *texture );
-
-		_load_pixels( texture );
-		_fit_image();
+		_cancel_load_job();
+		m_load_job = std::make_unique< ImageLoadJob >( _path );
 	}
 
 	void CanvasManager::set_original_sprite_opacity( float _opacity )
 	{
-		const uint8_t alpha{ static_cast< uint8_t >( _opacity / 100.f * 255.f ) };
-
-		for( int quad_index{ 0 }; quad_index < m_base_pixels.getVertexCount(); quad_index += 4 )
-		{
-			m_base_pixels[ quad_index ].color.a		= alpha;
-			m_base_pixels[ quad_index + 1 ].color.a = alpha;
-			m_base_pixels[ quad_index + 2 ].color.a = alpha;
-			m_base_pixels[ quad_index + 3 ].color.a = alpha;
-		}
+		m_original_opacity = static_cast< uint8_t >( _opacity / 100.f * 255.f );
 	}
 
 	/**
 	* @brief Retrieve all same colored pixels as the given color.
-	* @param _area_color The color to find in the pixel descs array.
+	* @param _area_color The color to find in the pixels.
 	**/
 	void CanvasManager::compute_pixel_area( const ColorInfos& _area_color )
 	{
+		const uint16_t area_palette_index{ _get_palette_index( _area_color ) };
+
 		// First, we check if we already have hovered pixels and if they are the same color as the given one.
 		// If that's the case, we don't need to compute areas again.
-		if( m_hovered_color.m_pixel_areas.empty() == false && m_hovered_color.m_pixel_areas.front().empty() == false )
-		{
-			// Separating the tests for lisibility
-			if( *m_hovered_color.m_pixel_areas.front().front()->m_color_infos == _area_color )
-				return;
-		}
+		if( m_hovered_color.m_areas.empty() == false && m_area_labels.get_area( m_hovered_color.m_areas.front() ).m_palette_index == area_palette_index )
+			return;
 		
-		std::vector< uint32_t > treated_indexes;
 		m_hovered_color.reset();
 
-		_compute_pixel_area( _area_color, treated_indexes );
-	}
-
-	//
-	// Load the base vertex array from the chosen image
-	//
-	void CanvasManager::_load_pixels( sf::Texture* _texture )
-	{
-		if( _texture == nullptr )
+		if( area_palette_index == PixelStore::Invalid_Index )
 			return;
 
-		m_base_pixels.clear();
-		m_converted_pixels.clear();
-		m_pixels_descs.clear();
-
-		const auto image{ _texture->copyToImage() };
-		auto color_values{ image.getPixelsPtr() };
-		m_image_size = image.getSize();
-
-		auto image_pos_min = sf::Vector2f{ Flt_Max, Flt_Max };
-		auto image_pos_max = sf::Vector2f{ -1.f, -1.f };
-		const auto max_pixel_index{ m_image_size.x * m_image_size.y * ColorChannel::COUNT };
-		uint32_t quad_index{ 0 };
+		_update_area_labels();
+		_compute_pixel_area( area_palette_index );
+	}
 
-		for( uint32_t value_index{ 0u }; value_index < max_pixel_index; value_index += ColorChannel::COUNT, color_values += ColorChannel::COUNT )
-		{
-			const sf::Color pixel_color{ color_values[ ColorChannel::red ], color_values[ ColorChannel::green ], color_values[ ColorChannel::blue ], color_values[ ColorChannel::alpha ] };
+	/**
+	* @brief Give their palette color to the pixels of some distinct colors of a conversion, while one of its palette colors is being edited.
+	* @param _result			The conversion the distinct colors belong to.
+	* @param _distinct_colors	The distinct colors whose pixels have to be displayed again.
+	* @param _edited_index		The index of the edited color in the palette colors vector.
+	* @param _edited_color		The value of the edited color, displayed instead of the one in the palette.
+	**/
+	void CanvasManager::apply_edited_color( const ConversionResult& _result, std::span< const uint32_t > _distinct_colors, uint16_t _edited_index, const ImColor& _edited_color )
+	{
+		const ColorPalette* palette{ g_pixeler->get_palettes_manager().get_palette( _result.get_palette_name() ) };
 
-			m_pixels_descs.push_back( { .m_base_color = pixel_color, .m_pixel_index = m_pixels_descs.size() } );
+		if( palette == nullptr || _result.get_nb_pixels() != m_pixels.get_nb_pixels() )
+			return;
 
-			if( pixel_color.a < 50 )
-				continue;
+		m_palette_name = _result.get_palette_name();
+		_update_palette_colors();
 
-			const uint32_t		pixel_index{ value_index / ColorChannel::COUNT };
-			const sf::Vector2f	pixel_position{ static_cast< float >( pixel_index % m_image_size.x ), static_cast<float>( pixel_index / m_image_size.x ) };
+		if( _edited_index < m_palette_colors.size() )
+			m_palette_colors[ _edited_index ] = Utils::to_sf_color( _edited_color );
 
-			if( pixel_position.x < image_pos_min.x )
-				image_pos_min.x = pixel_position.x;
+		_apply_distinct_colors( _result, _distinct_colors, palette->m_colors.size() );
 
-			if( pixel_position.y < image_pos_min.y )
-				image_pos_min.y = pixel_position.y;
+		// The areas are only labeled again once they are needed, not on each modification of the edited color.
+		m_hovered_color.reset();
+		m_last_hovered_pixel_index = Uint32_Max;
+		m_area_labels_outdated = true;
+		m_canvas_outdated = true;
+	}
 
-			if( pixel_position.x >= image_pos_max.x )
-				image_pos_max.x = pixel_position.x + 1.f;
+	/**
+	* @brief Cancel the image being loaded without waiting for its thread. The job is kept until its thread stopped.
+	**/
+	void CanvasManager::_cancel_load_job()
+	{
+		if( m_load_job == nullptr )
+			return;
 
-			if( pixel_position.y >= image_pos_max.y )
-				image_pos_max.y = pixel_position.y + 1.f;
+		m_load_job->cancel();
+		m_cancelled_load_jobs.push_back( std::move( m_load_job ) );
+	}
 
-			m_base_pixels.append( { { pixel_position + m_offsets[ 0 ] }, pixel_color } );
-			m_base_pixels.append( { { pixel_position + m_offsets[ 1 ] }, pixel_color } );
-			m_base_pixels.append( { { pixel_position + m_offsets[ 2 ] }, pixel_color } );
-			m_base_pixels.append( { { pixel_position + m_offsets[ 3 ] }, pixel_color } );
+	/**
+	* @brief Replace the displayed image by the one loaded by the load job, and forget everything computed on the previous one.
+	* @param [in] _result The loaded image, whose pixels and tiles are swapped with the current ones so the old textures are freed on the main thread.
+	**/
+	void CanvasManager::_apply_loaded_image( ImageLoadJob::Result& _result )
+	{
+		m_palette_name.clear();
+		m_palette_colors.clear();
+		m_hovered_color.reset();
+		m_last_hovered_pixel_index = Uint32_Max;
+		g_pixeler->get_palettes_manager().set_conversion_result( nullptr );
 
-			m_converted_pixels.append( { { pixel_position + m_offsets[ 0 ] }, pixel_color } );
-			m_converted_pixels.append( { { pixel_position + m_offsets[ 1 ] }, pixel_color } );
-			m_converted_pixels.append( { { pixel_position + m_offsets[ 2 ] }, pixel_color } );
-			m_converted_pixels.append( { { pixel_position + m_offsets[ 3 ] }, pixel_color } );
+		std::swap( m_pixels, _result.m_pixels );
+		std::swap( m_tiles, _result.m_tiles );
+		m_area_labels.clear();
+		m_area_labels_outdated = false;
+		m_outline_cache.clear();
 
-			m_pixels_descs.back().m_quad_index = quad_index++;
-		}
+		m_image_size = m_pixels.get_size();
+		m_image_float_rect = _result.m_opaque_rect;
+		m_canvas_outdated = true;
 
-		m_image_float_rect.left		= image_pos_min.x;
-		m_image_float_rect.top		= image_pos_min.y;
-		m_image_float_rect.width	= image_pos_max.x - image_pos_min.x;
-		m_image_float_rect.height	= image_pos_max.y - image_pos_min.y;
+		_fit_image();
 	}
 
 	//
@@ -216,72 +233,69 @@ namespace Pixeler
 		const float new_rect_width{ horizontal_ratio > vertical_ratio ? m_image_float_rect.width * vertical_ratio : m_canvas_size.x };
 		const float new_rect_height{ horizontal_ratio > vertical_ratio ? m_canvas_size.y : m_image_float_rect.height * horizontal_ratio };
 
-		_update_zoom_level( new_rect_width / m_image_float_rect.width );
+		m_zoom_level = new_rect_width / m_image_float_rect.width;
 
 		const float left{ ( m_canvas_size.x - new_rect_width ) * 0.5f };
 		const float top{ ( m_canvas_size.y - new_rect_height ) * 0.5f };
 
-		_set_vertex_array_pos( sf::Vector2f{ left, top } - sf::Vector2f{ m_image_float_rect.left, m_image_float_rect.top } * m_zoom_level );
+		_set_image_pos( sf::Vector2f{ left, top } - sf::Vector2f{ m_image_float_rect.left, m_image_float_rect.top } * m_zoom_level );
 	}
 
-	//
-	// Move all the pixels of the vertex array to the given position
-	//
-	void CanvasManager::_set_vertex_array_pos( const sf::Vector2f& _pos )
+	/**
+	* @brief Move the image to the given position on the canvas, keeping its zoom level.
+	* @param _pos The position of the top left corner of the image on the canvas.
+	**/
+	void CanvasManager::_set_image_pos( const sf::Vector2f& _pos )
 	{
 		m_image_offest = _pos;
 
-		for( int quad_index{ 0 }; quad_index < m_base_pixels.getVertexCount(); quad_index += 4 )
-		{
-			_set_quad_pos_and_zoom( m_base_pixels, quad_index, m_zoom_level, _pos );
-			_set_quad_pos_and_zoom( m_converted_pixels, quad_index, m_zoom_level, _pos );
-		}
-
-		_update_pixel_grid();
+		_update_image_transform();
 	}
 
-	//
-	// Move a quad to the given position and update its zoom level
-	//
-	void CanvasManager::_set_quad_pos_and_zoom( sf::VertexArray& _pixels, int _quad_index, float _zoom_level, const sf::Vector2f& _pos /*= { 0.f, 0.f }*/ )
+	/**
+	* @brief Change the zoom level of the image, keeping the image point under the given canvas position in place.
+	* @param _new_zoom_level	The new size of a pixel on the canvas.
+	* @param _pivot			The position on the canvas that mustn't move.
+	**/
+	void CanvasManager::_zoom_at( float _new_zoom_level, const sf::Vector2f& _pivot )
 	{
-		for( int quad_corner{ 0 }; quad_corner < 4; ++quad_corner )
-		{
-			auto base_index{ get_pixel_index( _quad_index / 4 ) };
-			auto base_pos = sf::Vector2f{ ( base_index % m_image_size.x ) * _zoom_level, ( base_index / m_image_size.x ) * _zoom_level };
+		const sf::Vector2f image_point{ ( _pivot - m_image_offest ) / m_zoom_level };
 
-			_pixels[ _quad_index + quad_corner ].position = _pos + base_pos + m_offsets[ quad_corner ] * _zoom_level;
-		}
+		m_zoom_level = _new_zoom_level;
+		_set_image_pos( _pivot - image_point * m_zoom_level );
 	}
 
-	//
-	// Update the pixels to a new zoom level
-	//
-	void CanvasManager::_update_zoom_level( float _new_pixel_size )
+	/**
+	* @brief Update the transform drawing the pixels on the canvas, and everything drawn in canvas space, after a change of the zoom level or the position of the image.
+	* The vertices stay in image space, so their positions don't have to be updated.
+	**/
+	void CanvasManager::_update_image_transform()
 	{
-		for( int quad_index{ 0 }; quad_index < m_base_pixels.getVertexCount(); quad_index += 4 )
-		{
-			_set_quad_pos_and_zoom( m_base_pixels, quad_index, _new_pixel_size );
-			_set_quad_pos_and_zoom( m_converted_pixels, quad_index, _new_pixel_size );
-		}
-
-		m_zoom_level = _new_pixel_size;
+		m_image_transform = sf::Transform::Identity;
+		m_image_transform.translate( m_image_offest );
+		m_image_transform.scale( m_zoom_level, m_zoom_level );
+		m_canvas_outdated = true;
 
 		_update_pixel_grid();
+		_compute_area_outline();
 	}
 
 	void CanvasManager::_update_pixel_grid()
 	{
+		m_pixel_grid.clear();
+
 		if( m_zoom_level <= 1.f )
 			return;
 
-		m_pixel_grid.clear();
-
 		auto& options_datas{ g_pixeler->get_options().get_options_datas() };
 		auto& canvas_bg_color{ sf::Color::Green };
-		float grid_position = m_image_offest.x + m_zoom_level;
 
-		while( grid_position < m_canvas_size.x )
+		// Only the lines between the pixels that are visible on the canvas are added, the image can be much larger than the canvas once zoomed.
+		const sf::Vector2f first_line{ std::max( std::ceil( -m_image_offest.x / m_zoom_level ), 1.f ), std::max( std::ceil( -m_image_offest.y / m_zoom_level ), 1.f ) };
+		const sf::Vector2f grid_end{ std::min( m_canvas_size.x, m_image_offest.x + m_image_size.x * m_zoom_level ), std::min( m_canvas_size.y, m_image_offest.y + m_image_size.y * m_zoom_level ) };
+		float grid_position = m_image_offest.x + m_zoom_level * first_line.x;
+
+		while( grid_position < grid_end.x )
 		{
 			m_pixel_grid.append( { { grid_position, 0.f }, canvas_bg_color } );
 			m_pixel_grid.append( { { grid_position, m_canvas_size.y + 0.f }, canvas_bg_color } );
@@ -289,8 +303,8 @@ namespace Pixeler
 			grid_position += m_zoom_level;
 		}
 
-		grid_position = m_image_offest.y + m_zoom_level;
-		while( grid_position < m_canvas_size.y )
+		grid_position = m_image_offest.y + m_zoom_level * first_line.y;
+		while( grid_position < grid_end.y )
 		{
 			m_pixel_grid.append( { { 0.f, grid_position }, canvas_bg_color } );
 			m_pixel_grid.append( { { m_canvas_size.x + 0.f, grid_position }, canvas_bg_color } );
@@ -304,88 +318,161 @@ namespace Pixeler
 	//
 	void CanvasManager::_convert_image_colors()
 	{
-		const PalettesManager& palettes_manager{ g_pixeler->get_palettes_manager() };
+		PalettesManager& palettes_manager{ g_pixeler->get_palettes_manager() };
+		const std::shared_ptr< const ConversionResult > current_result{ palettes_manager.get_conversion_result() };
+		auto result{ std::make_shared< ConversionResult >() };
+
+		// The distinct colors of the image and their palette candidates don't change until another image is loaded, so they are reused by the following conversions.
+		const bool colors_shared{ current_result != nullptr && current_result->get_nb_pixels() == m_pixels.get_nb_pixels() };
 
-		for( int quad_index{ 0 }; quad_index < m_base_pixels.getVertexCount(); quad_index += 4 )
+		if( colors_shared )
+			result->share_colors( *current_result );
+		else
 		{
-			auto [ new_color, color_infos ] = palettes_manager.convert_color( m_base_pixels[ quad_index ].color );
-			
-			m_converted_pixels[ quad_index + 0 ].color = new_color;
-			m_converted_pixels[ quad_index + 1 ].color = new_color;
-			m_converted_pixels[ quad_index + 2 ].color = new_color;
-			m_converted_pixels[ quad_index + 3 ].color = new_color;
-
-			if( auto* pixel_desc = get_pixel_desc( quad_index / 4 ) )
-				pixel_desc->m_color_infos = color_infos;
+			// Images usually contain far less colors than pixels, so each distinct color is converted only once and its result is given to all the pixels using it.
+			result->gather_colors( m_pixels.get_base_colors(), m_image_size.x );
 		}
-	}
 
-	// 
-	// @brief Get the corresponding pixel index to the given quad index.
-	// @param _quad_index id of the quad in the vertex array. 0 is the first quad created/used in the picture.
-	// @return Pixel index: id of the pixel in the image, transparent pixels included. 0 is the very first pixel at the top left of the picture.
-	// 
-	uint32_t CanvasManager::get_pixel_index( uint32_t _quad_index )
-	{
-		auto it = std::ranges::find( m_pixels_descs, _quad_index, &PixelDesc::m_quad_index );
-		
-		if( it != m_pixels_descs.end() )
-			return it - m_pixels_descs.begin();
+		palettes_manager.prepare_conversion( *result );
+		palettes_manager.convert( *result );
 
-		return 0u;
+		_apply_conversion_result( *result );
+		palettes_manager.set_conversion_result( result );
+
+		const float gathering_time{ colors_shared ? 0.f : result->get_gathering_time().count() };
+
+		FZN_DBLOG( "Converted %zu pixels using %zu distinct colors in %.2fms (%.2fms gathering colors).", m_pixels.get_nb_opaque_pixels(), result->get_distinct_colors().size()
+			, gathering_time + result->get_conversion_time().count(), gathering_time );
 	}
 
-	CanvasManager::PixelDesc* CanvasManager::get_pixel_desc( uint32_t _quad_index )
+	//
+	// Give their new colors to the pixels from the given conversion result
+	//
+	void CanvasManager::_apply_conversion_result( const ConversionResult& _result )
 	{
-		auto it = std::ranges::find( m_pixels_descs, _quad_index, &PixelDesc::m_quad_index );
+		// The index plane shows the conversion the result was shared from, so after a change of selection only the pixels of the colors changing of palette color are written again.
+		const bool same_conversion{ _result.has_changed_colors_only() && _result.get_palette_name() == m_palette_name };
+
+		m_palette_name = _result.is_converted() ? _result.get_palette_name() : std::string{};
+
+		const ColorPalette* palette{ _get_palette() };
+
+		// The index plane is the converted image, the textures of the tiles are only a view of it.
+		if( palette == nullptr || _result.get_nb_pixels() != m_pixels.get_nb_pixels() )
+		{
+			m_pixels.clear_palette_indices();
+			m_tiles.invalidate_converted();
+		}
+		else if( same_conversion )
+			_apply_distinct_colors( _result, _result.get_changed_colors(), palette->m_colors.size() );
+		else
+		{
+			_result.fill_palette_indices( m_pixels.get_palette_indices() );
+			m_tiles.invalidate_converted();
+		}
 
-		if( it != m_pixels_descs.end() )
-			return &(*it);
+		_update_palette_colors();
+		m_canvas_outdated = true;
 
-		return nullptr;
+		// The hovered areas are labels of the previous conversion, they are only labeled again once they are needed.
+		m_hovered_color.reset();
+		m_last_hovered_pixel_index = Uint32_Max;
+		m_area_labels_outdated = true;
 	}
 
-	CanvasManager::PixelDesc* CanvasManager::_get_pixel_desc_in_direction( const PixelDesc& _pixel, Direction _direction )
+	/**
+	* @brief Give their palette color to the pixels of some distinct colors of a conversion, and build the tiles containing them again once they are visible.
+	* @param [in] _result				The conversion the distinct colors belong to.
+	* @param [in] _distinct_colors		The distinct colors whose pixels changed of palette color.
+	* @param [in] _nb_palette_colors	The number of colors of the palette used for the conversion.
+	**/
+	void CanvasManager::_apply_distinct_colors( const ConversionResult& _result, std::span< const uint32_t > _distinct_colors, size_t _nb_palette_colors )
 	{
-		const PixelPosition pixel_position{ _get_2D_position( _pixel.m_pixel_index ) };
+		const std::vector< uint16_t >& palette_indices{ _result.get_colors_palette_indices() };
+		size_t nb_pixels{ 0 };
 
-		uint32_t new_pixel_index{ 0u };
+		for( const uint32_t color : _distinct_colors )
+			nb_pixels += _result.get_color_pixels( color ).size();
 
-		switch( _direction )
+		// Each task only writes the palette indices of the pixels of its own colors.
+		Utils::parallel_for( _distinct_colors.size(), std::min( Utils::get_nb_tasks( nb_pixels, Min_Pixels_Per_Task ), _distinct_colors.size() ), [&]( size_t /*_task*/, size_t _first_color, size_t _last_color )
 		{
-			case Pixeler::Direction::up:
-			{
-				new_pixel_index = _get_1D_index( { pixel_position.x, pixel_position.y - 1 } );
-				break;
-			}
-			case Pixeler::Direction::down:
-			{
-				new_pixel_index = _get_1D_index( { pixel_position.x, pixel_position.y + 1 } );
-				break;
-			}
-			case Pixeler::Direction::left:
-			{
-				new_pixel_index = _get_1D_index( { pixel_position.x - 1, pixel_position.y } );
-				break;
-			}
-			case Pixeler::Direction::right:
+			for( size_t color{ _first_color }; color < _last_color; ++color )
 			{
-				new_pixel_index = _get_1D_index( { pixel_position.x + 1, pixel_position.y } );
-				break;
+				const uint16_t palette_index{ palette_indices[ _distinct_colors[ color ] ] };
+				const uint16_t pixels_palette_index{ palette_index < _nb_palette_colors ? palette_index : PixelStore::Invalid_Index };
+
+				for( const uint32_t pixel : _result.get_color_pixels( _distinct_colors[ color ] ) )
+					m_pixels.set_palette_index( pixel, pixels_palette_index );
 			}
-			default:
-				return nullptr;
+		} );
+
+		// Only the tiles containing changed pixels are built again, once they are visible.
+		for( const uint32_t color : _distinct_colors )
+		{
+			for( const uint32_t pixel : _result.get_color_pixels( color ) )
+				m_tiles.invalidate_converted_pixel( pixel );
 		}
+	}
 
-		if( new_pixel_index >= m_pixels_descs.size() )
+	/**
+	* @brief Get the palette of the displayed conversion. It is looked up by name each time, as adding or removing palettes moves them.
+	* @return A pointer to the palette, nullptr if the image isn't converted or the palette has been deleted.
+	**/
+	const ColorPalette* CanvasManager::_get_palette() const
+	{
+		if( m_palette_name.empty() )
 			return nullptr;
 
-		PixelDesc& pixel_desc{ m_pixels_descs[ new_pixel_index ] };
+		return g_pixeler->get_palettes_manager().get_palette( m_palette_name );
+	}
+
+	/**
+	* @brief Get the displayed color of each palette index from the palette of the displayed conversion.
+	**/
+	void CanvasManager::_update_palette_colors()
+	{
+		m_palette_colors.clear();
+
+		if( const ColorPalette* palette{ _get_palette() } )
+			std::ranges::transform( palette->m_colors, std::back_inserter( m_palette_colors ), []( const ColorInfos& _color ) { return Utils::to_sf_color( _color.m_color ); } );
+	}
+
+	/**
+	* @brief Get the palette color of a pixel.
+	* @param _pixel_index Index of the pixel in the image.
+	* @return A pointer to the color in the palette of the displayed conversion, nullptr if the pixel has none.
+	**/
+	const ColorInfos* CanvasManager::_get_color_infos( uint32_t _pixel_index ) const
+	{
+		const ColorPalette* palette{ _get_palette() };
 
-		if( pixel_desc.m_color_infos == nullptr || pixel_desc.m_color_infos->is_valid() == false )
+		if( palette == nullptr || _pixel_index >= m_pixels.get_nb_pixels() )
 			return nullptr;
 
-		return &pixel_desc;
+		const uint16_t palette_index{ m_pixels.get_palette_index( _pixel_index ) };
+
+		return palette_index < palette->m_colors.size() ? &palette->m_colors[ palette_index ] : nullptr;
+	}
+
+	/**
+	* @brief Get the index of a color in the palette of the displayed conversion.
+	* @param _color The color to find.
+	* @return The index of the color in the palette colors vector, PixelStore::Invalid_Index if it isn't part of it.
+	**/
+	uint16_t CanvasManager::_get_palette_index( const ColorInfos& _color ) const
+	{
+		const ColorPalette* palette{ _get_palette() };
+
+		if( palette == nullptr )
+			return PixelStore::Invalid_Index;
+
+		const auto it = std::ranges::find( palette->m_colors, _color );
+
+		if( it == palette->m_colors.end() )
+			return PixelStore::Invalid_Index;
+
+		return static_cast< uint16_t >( it - palette->m_colors.begin() );
 	}
 
 	//
@@ -430,89 +517,58 @@ namespace Pixeler
 		return { pos_x, pos_y };
 	}
 
-	void CanvasManager::_get_colored_pixels_in_area( uint32_t _pixel_index, const ColorInfos& _area_color, PixelDescsPtr& _pixel_area, std::vector< uint32_t >& _treated_indexes )
+	/**
+	* @brief Label the areas of the converted image again if its palette indices changed since they were last labeled.
+	**/
+	void CanvasManager::_update_area_labels()
 	{
-		if( _pixel_index >= m_pixels_descs.size() )
-			return;
-
-		if( std::ranges::find( _treated_indexes, _pixel_index ) != _treated_indexes.end() )
-			return;
-
-		PixelDesc& pixel_desc{ m_pixels_descs[ _pixel_index ] };
-
-		if( pixel_desc.m_color_infos == nullptr || pixel_desc.m_color_infos->is_valid() == false )
-			return;
-
-		_treated_indexes.push_back( _pixel_index );
-
-		if( *pixel_desc.m_color_infos == _area_color )
-			_pixel_area.push_back( &pixel_desc );
-		else
+		if( m_area_labels_outdated == false )
 			return;
 
-		const PixelPosition pixel_position{ _get_2D_position( _pixel_index ) };
-
-		_get_colored_pixels_in_area( _get_1D_index( { pixel_position.x		, pixel_position.y - 1 } ),		_area_color, _pixel_area, _treated_indexes );		// Up
-		_get_colored_pixels_in_area( _get_1D_index( { pixel_position.x		, pixel_position.y + 1 } ),		_area_color, _pixel_area, _treated_indexes );		// Down
-		_get_colored_pixels_in_area( _get_1D_index( { pixel_position.x - 1	, pixel_position.y } ),			_area_color, _pixel_area, _treated_indexes );		// Left
-		_get_colored_pixels_in_area( _get_1D_index( { pixel_position.x + 1	, pixel_position.y } ),			_area_color, _pixel_area, _treated_indexes );		// Right
+		m_area_labels.compute( m_pixels );
+		m_area_labels_outdated = false;
+		m_outline_cache.clear();
 	}
 
 	/**
 	* @brief Retrieve all same colored pixels as the one at the given index.
-	* @param _pixel_index Index in the pixel descs array.
+	* @param _pixel_index Index of the pixel in the image.
 	**/
 	void CanvasManager::_compute_pixel_area( uint32_t _pixel_index )
 	{
-		// reset hovered color
-		// create treated indexes
-		// compute hoevered area around mouse
-
-		if( _pixel_index >= m_pixels_descs.size() )
-			return;
+		const ColorInfos* color_infos{ _get_color_infos( _pixel_index ) };
 
-		if( m_pixels_descs[ _pixel_index ].m_color_infos == nullptr || m_pixels_descs[ _pixel_index ].m_color_infos->is_valid() == false )
+		if( color_infos == nullptr || color_infos->is_valid() == false )
 			return;
 
-		std::vector< uint32_t > treated_indexes;
 		m_hovered_color.reset();
+		_update_area_labels();
 
-		const ColorInfos* color_to_find{ m_pixels_descs[ _pixel_index ].m_color_infos };
+		const uint32_t hovered_area{ m_area_labels.get_pixel_area( _pixel_index ) };
 
-		m_hovered_color.m_pixel_areas.push_back( {} );
-		_get_colored_pixels_in_area( _pixel_index, *color_to_find, m_hovered_color.m_pixel_areas.back(), treated_indexes );
+		if( hovered_area == AreaLabels::Invalid_Area )
+			return;
 
-		if( m_hovered_color.m_pixel_areas.back().empty() )
-			m_hovered_color.m_pixel_areas.pop_back();
-		else
-			m_hovered_color.m_first_area_hovered = true;
+		m_hovered_color.m_areas.push_back( hovered_area );
+		m_hovered_color.m_first_area_hovered = true;
 
-		_compute_pixel_area( *color_to_find, treated_indexes );
+		_compute_pixel_area( m_area_labels.get_area( hovered_area ).m_palette_index );
 	}
 
 	/**
 	* @brief Retrieve all same colored pixels as the given color.
 	* @warning This function is not meant to be called first, it is called by the two others of the same name that set up some variables first.
-	* @param _area_color The color to find in the pixel descs array.
-	* @param _treated_indexes An array containing all the previously checked pixel indexes.
+	* @param _area_palette_index The index in the palette colors vector of the color to find in the pixels.
 	**/
-	void CanvasManager::_compute_pixel_area( const ColorInfos& _area_color, std::vector< uint32_t >& _treated_indexes )
+	void CanvasManager::_compute_pixel_area( uint16_t _area_palette_index )
 	{
-		// for loop indexes 0 > size
-		// look for right color
-		for( uint32_t pixel_index{ 0u }; pixel_index < m_pixels_descs.size(); ++pixel_index )
+		for( const uint32_t area : m_area_labels.get_color_areas( _area_palette_index ) )
 		{
-			if( m_pixels_descs[ pixel_index ].m_color_infos == nullptr || *m_pixels_descs[ pixel_index ].m_color_infos != _area_color )
-				continue;
-
-			if( std::ranges::find( _treated_indexes, pixel_index ) != _treated_indexes.end() )
+			// The hovered area is already the first one.
+			if( m_hovered_color.m_first_area_hovered && area == m_hovered_color.m_areas.front() )
 				continue;
 
-			m_hovered_color.m_pixel_areas.push_back( {} );
-			_get_colored_pixels_in_area( pixel_index, _area_color, m_hovered_color.m_pixel_areas.back(), _treated_indexes );
-
-			if( m_hovered_color.m_pixel_areas.back().empty() )
-				m_hovered_color.m_pixel_areas.pop_back();
+			m_hovered_color.m_areas.push_back( area );
 		}
 
 		_compute_area_outline();
@@ -520,7 +576,7 @@ namespace Pixeler
 
 	void CanvasManager::_compute_area_outline()
 	{
-		if( m_hovered_color.m_pixel_areas.empty() )
+		if( m_hovered_color.m_areas.empty() )
 			return;
 
 		auto& options_datas{ g_pixeler->get_options().get_options_datas() };
@@ -528,50 +584,30 @@ namespace Pixeler
 
 		const float titlebar_height{ ImGui::GetFontSize() + ImGui::GetStyle().FramePadding.y * 2.0f };
 
-		auto add_neighbor_points = [&]( sf::VertexArray& _points, const PixelDesc& _pixel, Direction _direction )
-		{
-			PixelDesc* neighbor_pixel{ _get_pixel_desc_in_direction( _pixel, _direction ) };
-			if( neighbor_pixel == nullptr || *_pixel.m_color_infos != *neighbor_pixel->m_color_infos )
-			{
-				const PixelPosition pixel_position{ _get_2D_position( _pixel.m_pixel_index ) };
-				sf::Vector2f point_A{ m_sprite.getPosition() + m_image_offest };
-				point_A.x += pixel_position.x * m_zoom_level;
-				point_A.y += pixel_position.y * m_zoom_level - titlebar_height;
+		// The contours are cached in image space, only the canvas transform is applied to them again when the view changes.
+		// The lines are built on the canvas so their thickness doesn't depend on the zoom level.
+		sf::Transform outline_transform{};
+		outline_transform.translate( m_sprite.getPosition() - sf::Vector2f{ 0.f, titlebar_height } );
+		outline_transform.combine( m_image_transform );
 
-				sf::Vector2f point_B{ point_A };
+		// Each straight run of the contours of the area becomes a single segment, the segments of a contour are joined end to end.
+		auto add_area_outline = [&]( sf::VertexArray& _points, uint32_t _area )
+		{
+			const AreaLabels::Contours& contours{ m_outline_cache.get_contours( m_area_labels, _area ) };
+			const std::vector< sf::Vector2u >& corners{ contours.m_corners };
+			uint32_t first_corner{ 0 };
 
-				switch( _direction )
+			for( const uint32_t contour_end : contours.m_contour_ends )
+			{
+				for( uint32_t corner{ first_corner }; corner < contour_end; ++corner )
 				{
-					case Pixeler::Direction::up:
-					{
-						point_B.x += m_zoom_level;
-						break;
-					}
-					case Pixeler::Direction::down:
-					{
-						point_A.y += m_zoom_level;
-						point_B.x += m_zoom_level;
-						point_B.y += m_zoom_level;
-						break;
-					}
-					case Pixeler::Direction::left:
-					{
-						point_B.y += m_zoom_level;
-						break;
-					}
-					case Pixeler::Direction::right:
-					{
-						point_A.x += m_zoom_level;
-						point_B.x += m_zoom_level;
-						point_B.y += m_zoom_level;
-						break;
-					}
-					default:
-						break;
+					const uint32_t next_corner{ corner + 1 < contour_end ? corner + 1 : first_corner };
+
+					_points.append( { outline_transform.transformPoint( sf::Vector2f{ corners[ corner ] } ) } );
+					_points.append( { outline_transform.transformPoint( sf::Vector2f{ corners[ next_corner ] } ) } );
 				}
 
-				_points.append( { point_A } );
-				_points.append( { point_B } );
+				first_corner = contour_end;
 			}
 		};
 
@@ -580,16 +616,7 @@ namespace Pixeler
 
 		if( m_hovered_color.m_first_area_hovered )
 		{
-			for( const PixelDesc* pixel_desc : m_hovered_color.m_pixel_areas.front() )
-			{
-				if( pixel_desc == nullptr )
-					continue;
-
-				add_neighbor_points( m_hovered_color.m_hovered_area_points, *pixel_desc, Direction::up );
-				add_neighbor_points( m_hovered_color.m_hovered_area_points, *pixel_desc, Direction::down );
-				add_neighbor_points( m_hovered_color.m_hovered_area_points, *pixel_desc, Direction::left );
-				add_neighbor_points( m_hovered_color.m_hovered_area_points, *pixel_desc, Direction::right );
-			}
+			add_area_outline( m_hovered_color.m_hovered_area_points, m_hovered_color.m_areas.front() );
 
 			if( m_hovered_color.m_hovered_area_points.getVertexCount() > 0 )
 			{
@@ -602,34 +629,26 @@ namespace Pixeler
 			area_color = options_datas.m_area_secondary_highlight_color;
 		}
 
-		for( ; area_index < m_hovered_color.m_pixel_areas.size(); ++area_index )
-		{
-			for( const PixelDesc* pixel_desc : m_hovered_color.m_pixel_areas[ area_index ] )
-			{
-				if( pixel_desc == nullptr )
-					continue;
-
-				add_neighbor_points( m_hovered_color.m_colored_area_points, *pixel_desc, Direction::up );
-				add_neighbor_points( m_hovered_color.m_colored_area_points, *pixel_desc, Direction::down );
-				add_neighbor_points( m_hovered_color.m_colored_area_points, *pixel_desc, Direction::left );
-				add_neighbor_points( m_hovered_color.m_colored_area_points, *pixel_desc, Direction::right );
-			}
+		for( ; area_index < m_hovered_color.m_areas.size(); ++area_index )
+			add_area_outline( m_hovered_color.m_colored_area_points, m_hovered_color.m_areas[ area_index ] );
 
-			if( m_hovered_color.m_colored_area_points.getVertexCount() > 0 )
-			{
-				m_hovered_color.m_colored_area_line.set_thickness( options_datas.m_area_secondary_highlight_thickness );
-				m_hovered_color.m_colored_area_line.set_color( area_color );
-				m_hovered_color.m_colored_area_line.from_vertex_array( m_hovered_color.m_colored_area_points );
-			}
+		// The line of the other areas is built once, from the contours of all of them.
+		if( m_hovered_color.m_colored_area_points.getVertexCount() > 0 )
+		{
+			m_hovered_color.m_colored_area_line.set_thickness( options_datas.m_area_secondary_highlight_thickness );
+			m_hovered_color.m_colored_area_line.set_color( area_color );
+			m_hovered_color.m_colored_area_line.from_vertex_array( m_hovered_color.m_colored_area_points );
 		}
+
+		m_hovered_color.m_lines_changed = true;
 	}
 
 	bool CanvasManager::_is_pixel_in_current_area( uint32_t _pixel_index ) const
 	{
-		if( m_hovered_color.m_pixel_areas.empty() )
+		if( m_hovered_color.m_areas.empty() )
 			return false;
 
-		return std::ranges::find( m_hovered_color.m_pixel_areas.front(), _pixel_index, &PixelDesc::m_pixel_index ) != m_hovered_color.m_pixel_areas.front().end();
+		return m_area_labels.get_pixel_area( _pixel_index ) == m_hovered_color.m_areas.front();
 	}
 
 	///////////////// IMGUI /////////////////
@@ -643,17 +662,85 @@ namespace Pixeler
 		m_grid_sprite.setTextureRect( { 0, 0, (int)m_canvas_size.x, (int)m_canvas_size.y } );
 		m_test_image_sprite.setTextureRect( { 0, 0, (int)m_canvas_size.x, (int)m_canvas_size.y } );	// Needed when resizing.
 		m_sprite.setPosition( ImGui::GetWindowPos() /*+ sf::Vector2f{ 0.f, 1000.f }*/ );
+
+		const RenderSettings render_settings{
+			sf::Vector2f{ m_canvas_size },
+			Utils::to_sf_color( options_datas.m_canvas_background_color ),
+			Utils::to_sf_color( options_datas.m_grid_color ),
+			options_datas.m_grid_same_color_as_canvas,
+			options_datas.m_show_grid,
+			options_datas.m_show_original && options_datas.m_original_opacity_pct > 0.f,
+			m_original_opacity,
+			Utils::to_sf_color( options_datas.m_area_highlight_color ),
+			options_datas.m_area_highlight_thickness,
+			Utils::to_sf_color( options_datas.m_area_secondary_highlight_color ),
+			options_datas.m_area_secondary_highlight_thickness,
+			options_datas.m_show_secondary_highlight,
+			options_datas.m_show_minimap
+		};
+
+		// The outline lines are built with the highlight colors and thicknesses, so they are built again when those change.
+		if( render_settings.m_highlight_color != m_render_settings.m_highlight_color || render_settings.m_highlight_thickness != m_render_settings.m_highlight_thickness
+			|| render_settings.m_secondary_highlight_color != m_render_settings.m_secondary_highlight_color || render_settings.m_secondary_highlight_thickness != m_render_settings.m_secondary_highlight_thickness )
+			_compute_area_outline();
+
+		// The render texture keeps the last drawn canvas, it is only drawn again when something displayed on it changed.
+		if( m_canvas_outdated || m_hovered_color.m_lines_changed || render_settings != m_render_settings )
+		{
+			m_render_settings = render_settings;
+			m_canvas_outdated = false;
+			m_hovered_color.m_lines_changed = false;
+
+			_draw_canvas( _bg_color );
+		}
+		else
+			++m_nb_skipped_frames;
+
+		ImGui::Image( m_sprite );
+
+		if( ImGui::IsItemHovered() )
+		{
+			if( options_datas.m_show_minimap && _minimap_navigation() )
+			{
+				m_last_hovered_pixel_index = Uint32_Max;
+				m_hovered_color.reset();
+			}
+			else
+			{
+				_mouse_zoom_and_pan();
+				_mouse_detection();
+			}
+		}
+		else
+		{
+			m_last_hovered_pixel_index = Uint32_Max;
+			m_hovered_color.reset();
+		}
+	}
+
+	/**
+	* @brief Draw the image, the grid, the outlines and the minimap in the render texture displayed on the canvas.
+	* @param _bg_color The background color of the canvas.
+	**/
+	void CanvasManager::_draw_canvas( const sf::Color& _bg_color )
+	{
+		auto& options_datas{ g_pixeler->get_options().get_options_datas() };
+
 		m_render_texture.clear( sf::Color::Transparent );
 
-		if( m_converted_pixels.getVertexCount() > 0 )
+		if( m_pixels.get_nb_opaque_pixels() > 0 )
 		{
+			// Only the tiles intersecting the canvas are built and drawn.
+			const sf::FloatRect visible_rect{ m_image_transform.getInverse().transformRect( { 0.f, 0.f, m_canvas_size.x, m_canvas_size.y } ) };
+			m_tiles.update( visible_rect, m_zoom_level, m_pixels, m_palette_colors );
+
 			m_test_texture.clear( sf::Color::Transparent );
-			m_test_texture.draw( m_converted_pixels );
+			m_tiles.draw( m_test_texture, m_image_transform, CanvasTiles::Layer::converted );
 			m_test_texture.display();
 			m_render_texture.draw( m_test_image_sprite );
 
 			if( options_datas.m_show_original && options_datas.m_original_opacity_pct > 0.f )
-				m_render_texture.draw( m_base_pixels );
+				m_tiles.draw( m_render_texture, m_image_transform, CanvasTiles::Layer::base, { 255, 255, 255, m_original_opacity } );
 
 			m_grid_texture.clear( sf::Color::Transparent );
 
@@ -687,21 +774,112 @@ namespace Pixeler
 		if( m_hovered_color.m_hovered_area_line.is_empty() == false )
 			m_render_texture.draw( m_hovered_color.m_hovered_area_line );
 
+		if( options_datas.m_show_minimap && m_pixels.get_nb_opaque_pixels() > 0 )
+			_draw_minimap( _bg_color );
+
 		m_render_texture.display();
-		ImGui::Image( m_sprite );
+	}
 
-		if( ImGui::IsItemHovered() )
-			_mouse_detection();
-		else
+	/**
+	* @brief Zoom on the mouse position with the mouse wheel, and move the image while the middle button is held.
+	**/
+	void CanvasManager::_mouse_zoom_and_pan()
+	{
+		if( m_pixels.get_nb_opaque_pixels() == 0 )
+			return;
+
+		const ImGuiIO& io{ ImGui::GetIO() };
+
+		if( io.MouseWheel != 0.f )
 		{
-			m_last_hovered_pixel_index = Uint32_Max;
-			m_hovered_color.reset();
+			const float new_zoom_level{ std::clamp( m_zoom_level * std::pow( Mouse_Wheel_Zoom_Factor, io.MouseWheel ), Min_Zoom_Level, Max_Zoom_Level ) };
+
+			if( new_zoom_level != m_zoom_level )
+				_zoom_at( new_zoom_level, _get_mouse_pos() );
+		}
+
+		if( ImGui::IsMouseDragging( ImGuiMouseButton_Middle, 0.f ) && ( io.MouseDelta.x != 0.f || io.MouseDelta.y != 0.f ) )
+			_set_image_pos( m_image_offest + sf::Vector2f{ io.MouseDelta } );
+	}
+
+	/**
+	* @brief Get the transform drawing the whole image in the minimap, at the bottom right corner of the canvas.
+	**/
+	sf::Transform CanvasManager::_get_minimap_transform() const
+	{
+		const float scale{ Minimap_Size / static_cast< float >( std::max( m_image_size.x, m_image_size.y ) ) };
+		const sf::Vector2f minimap_size{ sf::Vector2f{ m_image_size } * scale };
+
+		sf::Transform minimap_transform{};
+		minimap_transform.translate( sf::Vector2f{ m_canvas_size } - minimap_size - sf::Vector2f{ Minimap_Margin, Minimap_Margin } );
+		minimap_transform.scale( scale, scale );
+
+		return minimap_transform;
+	}
+
+	/**
+	* @brief Draw an overview of the converted image at the bottom right corner of the canvas, with the part of it visible on the canvas.
+	* @param _bg_color The background color of the canvas.
+	**/
+	void CanvasManager::_draw_minimap( const sf::Color& _bg_color )
+	{
+		const sf::Transform minimap_transform{ _get_minimap_transform() };
+		const sf::FloatRect minimap_rect{ minimap_transform.transformRect( { 0.f, 0.f, static_cast< float >( m_image_size.x ), static_cast< float >( m_image_size.y ) } ) };
+
+		sf::RectangleShape background{ { minimap_rect.width, minimap_rect.height } };
+		background.setPosition( minimap_rect.left, minimap_rect.top );
+		background.setFillColor( _bg_color );
+		background.setOutlineColor( sf::Color{ 128, 128, 128 } );
+		background.setOutlineThickness( 1.f );
+		m_render_texture.draw( background );
+
+		m_tiles.draw_overview( m_render_texture, minimap_transform, CanvasTiles::Layer::converted );
+
+		const sf::FloatRect visible_rect{ minimap_transform.transformRect( m_image_transform.getInverse().transformRect( { 0.f, 0.f, m_canvas_size.x, m_canvas_size.y } ) ) };
+		sf::FloatRect visible_minimap_rect{};
+
+		if( visible_rect.intersects( minimap_rect, visible_minimap_rect ) == false )
+			return;
+
+		sf::RectangleShape visible_area{ { visible_minimap_rect.width, visible_minimap_rect.height } };
+		visible_area.setPosition( visible_minimap_rect.left, visible_minimap_rect.top );
+		visible_area.setFillColor( sf::Color::Transparent );
+		visible_area.setOutlineColor( sf::Color::Red );
+		visible_area.setOutlineThickness( 1.f );
+		m_render_texture.draw( visible_area );
+	}
+
+	/**
+	* @brief Center the canvas on the point of the image clicked in the minimap.
+	* @return True if the mouse is over the minimap, in which case it isn't over the image.
+	**/
+	bool CanvasManager::_minimap_navigation()
+	{
+		if( m_pixels.get_nb_opaque_pixels() == 0 )
+			return false;
+
+		const sf::Transform minimap_transform{ _get_minimap_transform() };
+		const sf::FloatRect minimap_rect{ minimap_transform.transformRect( { 0.f, 0.f, static_cast< float >( m_image_size.x ), static_cast< float >( m_image_size.y ) } ) };
+		const sf::Vector2f mouse_pos{ _get_mouse_pos() };
+
+		if( minimap_rect.contains( mouse_pos ) == false )
+			return false;
+
+		if( ImGui::IsMouseDown( ImGuiMouseButton_Left ) )
+		{
+			const sf::Vector2f image_point{ minimap_transform.getInverse().transformPoint( mouse_pos ) };
+			const sf::Vector2f new_image_pos{ sf::Vector2f{ m_canvas_size * 0.5f } - image_point * m_zoom_level };
+
+			if( new_image_pos != m_image_offest )
+				_set_image_pos( new_image_pos );
 		}
+
+		return true;
 	}
 
 	void CanvasManager::_mouse_detection()
 	{
-		if( m_converted_pixels.getVertexCount() <= 0 )
+		if( m_pixels.get_nb_opaque_pixels() == 0 )
 		{
 			m_hovered_color.reset();
 			return;
@@ -710,13 +888,13 @@ namespace Pixeler
 		const PixelPosition mouse_pixel_pos{ _get_mouse_pixel_pos() };
 		const uint32_t pixel_index{ _get_1D_index( mouse_pixel_pos ) };
 
-		if( pixel_index >= m_pixels_descs.size() )
+		if( pixel_index >= m_pixels.get_nb_pixels() )
 		{
 			m_hovered_color.reset();
 			return;
 		}
 
-		const ColorInfos* color{ m_pixels_descs[ pixel_index ].m_color_infos };
+		const ColorInfos* color{ _get_color_infos( pixel_index ) };
 
 		if( color == nullptr || color->is_valid() == false )
 		{
@@ -743,18 +921,18 @@ namespace Pixeler
 		ImGui::Separator();
 		ImGui::Text( "Area count:" );
 		ImGui::SameLine();
-		if( m_hovered_color.m_pixel_areas.empty() )
+		if( m_hovered_color.m_areas.empty() )
 			ImGui_fzn::bold_text( "0" );
 		else
-			ImGui_fzn::bold_text( "%d", m_hovered_color.m_pixel_areas.front().size() );
+			ImGui_fzn::bold_text( "%d", m_area_labels.get_area( m_hovered_color.m_areas.front() ).m_nb_pixels );
 
 		ImGui::Text( "Total count:" );
 		ImGui::SameLine();
-		ImGui_fzn::bold_text( "%d", color->m_count );
+		ImGui_fzn::bold_text( "%d", g_pixeler->get_palettes_manager().get_color_count( *color ) );
 
 		ImGui::Separator();
 		ImGui::Text( "Original color" );
-		Utils::color_details( m_pixels_descs[ pixel_index ].m_base_color );
+		Utils::color_details( m_pixels.get_base_color( pixel_index ) );
 
 		ImGui::EndTooltip();
 		ImGui::PopStyleVar();
@@ -779,11 +957,8 @@ namespace Pixeler
 		ImGui::SetNextItemWidth( DefaultWidgetSize.x );
 
 		auto new_pixel_size{ m_zoom_level };
-		if( ImGui_fzn::small_slider_float( "Zoom Level", new_pixel_size, 1.f, 100.f, "x%.0f", ImGuiSliderFlags_NoInput | ImGuiSliderFlags_AlwaysClamp ) )
-		{
-			_update_zoom_level( new_pixel_size );
-			_set_vertex_array_pos( {} );
-		}
+		if( ImGui_fzn::small_slider_float( "Zoom Level", new_pixel_size, Min_Zoom_Level, Max_Zoom_Level, "x%.2f", ImGuiSliderFlags_NoInput | ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic ) )
+			_zoom_at( new_pixel_size, sf::Vector2f{ m_canvas_size * 0.5f } );
 
 		ImGui::SameLine();
 
@@ -794,15 +969,33 @@ namespace Pixeler
 
 		if( ImGui::SmallButton( "Convert" ) )
 		{
-			// For now, resetting colors of all palettes. Later with a tab system, maybe only the selected one could be reset.
-			g_pixeler->get_palettes_manager().reset_color_counts( true );
 			_convert_image_colors();
 		}
 
+		ImGui::SameLine();
+		ImGui::TextColored( ImGui_fzn::color::dark_gray, "Skipped frames: %llu", static_cast< unsigned long long >( m_nb_skipped_frames ) );
+		if( ImGui::IsItemHovered() )
+			ImGui::SetTooltip( Tooltip_SkippedFrames );
+
 		ImGui::SameLine();
 		ImGui::TextColored( ImGui_fzn::color::dark_gray, "|" );
 		ImGui::SameLine();
 		g_pixeler->get_options().bottom_bar_options();
+
+		if( m_load_job != nullptr )
+		{
+			ImGui::SameLine();
+			ImGui::TextColored( ImGui_fzn::color::dark_gray, "|" );
+			ImGui::SameLine();
+
+			const float progress{ m_load_job->get_progress() };
+			const std::string progress_text{ fzn::Tools::Sprintf( "Loading %d%%", static_cast< int >( progress * 100.f ) ) };
+			ImGui::ProgressBar( progress, ImVec2{ DefaultWidgetSize.x, ImGui::GetTextLineHeight() }, progress_text.c_str() );
+			ImGui::SameLine();
+
+			if( ImGui::SmallButton( "Cancel" ) )
+				_cancel_load_job();
+		}
 	}
 
 } // namespace Pixeler
@@ -1,38 +1,28 @@
 #pragma once
 
+#include <span>
+
 #include <SFML/Graphics/VertexArray.hpp>
 
 #include <FZN/Display/Line.h>
 
 #include "Defines.h"
+#include "AreaLabels.h"
+#include "CanvasTiles.h"
 #include "ColorPalette.h"
-
-
-class sf::Texture;
+#include "ImageLoadJob.h"
+#include "OutlineCache.h"
+#include "PixelStore.h"
 
 
 namespace Pixeler
 {
 	struct ColorInfos;
+	class ConversionResult;
 
 
 	class CanvasManager
 	{
-		/************************************************************************
-		* @brief The informations available on a pixel displayed on the canvas.
-		************************************************************************/
-		struct PixelDesc
-		{
-			sf::Color			m_base_color{ sf::Color::Black };	// The color of the pixel before the convertion.
-			const ColorInfos*	m_color_infos{ nullptr };			// The informations on the new color given to the pixel. (Id, value, count, etc...)
-			uint32_t			m_quad_index{ Uint32_Max };			// The index of the quad in the sprite (only the created pixels, empty spaces don't have index, 0 is the first drawn pixel)
-			uint32_t			m_pixel_index{ Uint32_Max };		// The overall index of the pixel, including empty spaces. 0 is the top left most pixel in the image.
-		};
-		using PixelDescs = std::vector< PixelDesc >;		// A vector containing pixel descriptions
-		using PixelDescsPtr = std::vector< PixelDesc* >;	// A vector containing pointers to pixel descriptions. Used to represent areas of pixels.
-		using PixelAreas = std::vector< PixelDescsPtr >;	// A vector of pixel areas.
-
-
 		/************************************************************************
 		* @brief Computed informations about the pixel area hovered by the mouse on the canvas or in the colors list.
 		************************************************************************/
@@ -49,7 +39,7 @@ namespace Pixeler
 			**/
 			void reset()
 			{
-				m_pixel_areas.clear();
+				m_areas.clear();
 				m_first_area_hovered = false;
 
 				clear_vertices_and_lines();
@@ -57,14 +47,17 @@ namespace Pixeler
 
 			void clear_vertices_and_lines()
 			{
+				m_lines_changed |= m_hovered_area_line.is_empty() == false || m_colored_area_line.is_empty() == false;
+
 				m_hovered_area_points.clear();
 				m_hovered_area_line.clear();
 				m_colored_area_points.clear();
 				m_colored_area_line.clear();
 			}
 
-			PixelAreas		m_pixel_areas;					// A list of pixel areas the same color as the one hovered by the mouse.
+			std::vector< uint32_t > m_areas;				// The labels of the pixel areas the same color as the one hovered by the mouse.
 			bool			m_first_area_hovered{ false };	// If true, the first area in the vector represents the one hovered by the mouse.
+			bool			m_lines_changed{ false };		// The lines have been cleared or built again since the canvas was last drawn.
 
 			// Points and line of the canvas area hovered by the mouse
 			sf::VertexArray m_hovered_area_points;
@@ -75,46 +68,96 @@ namespace Pixeler
 			fzn::Line		m_colored_area_line;
 		};
 
+		/************************************************************************
+		* @brief The settings the canvas was last drawn with. The canvas is only drawn again when they change, or when what it displays is modified.
+		************************************************************************/
+		struct RenderSettings
+		{
+			bool operator==( const RenderSettings& ) const = default;
+
+			sf::Vector2f	m_canvas_size{};
+			sf::Color		m_background_color{};
+			sf::Color		m_grid_color{};
+			bool			m_grid_same_color_as_canvas{ false };
+			bool			m_show_grid{ false };
+			bool			m_show_original{ false };
+			uint8_t			m_original_opacity{ 0 };
+			sf::Color		m_highlight_color{};
+			float			m_highlight_thickness{ 0.f };
+			sf::Color		m_secondary_highlight_color{};
+			float			m_secondary_highlight_thickness{ 0.f };
+			bool			m_show_secondary_highlight{ false };
+			bool			m_show_minimap{ false };
+		};
+
 	public:
 		CanvasManager();
 		~CanvasManager();
 		
 		void on_event();
 
+		/**
+		* @brief Get the number of frames which displayed the previously drawn canvas because nothing had changed since.
+		**/
+		uint64_t get_nb_skipped_frames() const { return m_nb_skipped_frames; }
+
 		void update();
 
-		void load_texture( std::string_view _path );
+		/**
+		* @brief Start loading an image on a worker thread, cancelling the one being loaded. The image is decoded on the CPU and replaces the displayed one once it is entirely loaded.
+		* @param _path The path of the image.
+		**/
+		void load_image( std::string_view _path );
 
 		void set_original_sprite_opacity( float _opacity );
 
 		/**
 		* @brief Retrieve all same colored pixels as the given color.
-		* @param _area_color The color to find in the pixel descs array.
+		* @param _area_color The color to find in the pixels.
 		**/
 		void compute_pixel_area( const ColorInfos& _area_color );
 
+		/**
+		* @brief Give their palette color to the pixels of some distinct colors of a conversion, while one of its palette colors is being edited.
+		* @param _result			The conversion the distinct colors belong to.
+		* @param _distinct_colors	The distinct colors whose pixels have to be displayed again.
+		* @param _edited_index		The index of the edited color in the palette colors vector.
+		* @param _edited_color		The value of the edited color, displayed instead of the one in the palette.
+		**/
+		void apply_edited_color( const ConversionResult& _result, std::span< const uint32_t > _distinct_colors, uint16_t _edited_index, const ImColor& _edited_color );
+
 	private:
-		//
-		// Load the base vertex array from the chosen image
-		//
-		void _load_pixels( sf::Texture* _texture );
+		/**
+		* @brief Cancel the image being loaded without waiting for its thread. The job is kept until its thread stopped.
+		**/
+		void _cancel_load_job();
+
+		/**
+		* @brief Replace the displayed image by the one loaded by the load job, and forget everything computed on the previous one.
+		* @param [in] _result The loaded image, whose pixels and tiles are swapped with the current ones so the old textures are freed on the main thread.
+		**/
+		void _apply_loaded_image( ImageLoadJob::Result& _result );
 		//
 		// Change the position and zoom level of the image so it fits entirely in the canvas
 		//
 		void _fit_image();
-		//
-		// Move all the pixels of the vertex array to the given position
-		//
-		void _set_vertex_array_pos( const sf::Vector2f& _pos );
-		// 
-		// @brief Move a quad to the given position and update its zoom level
-		// @param _pixels The array containing all the quads.
-		// 
-		void _set_quad_pos_and_zoom( sf::VertexArray& _pixels, int _quad_index, float _zoom_level, const sf::Vector2f& _pos = { 0.f, 0.f } );
-		//
-		// Update the pixels to a new zoom level
-		//
-		void _update_zoom_level( float _new_zoom_level );
+		/**
+		* @brief Move the image to the given position on the canvas, keeping its zoom level.
+		* @param _pos The position of the top left corner of the image on the canvas.
+		**/
+		void _set_image_pos( const sf::Vector2f& _pos );
+
+		/**
+		* @brief Change the zoom level of the image, keeping the image point under the given canvas position in place.
+		* @param _new_zoom_level	The new size of a pixel on the canvas.
+		* @param _pivot			The position on the canvas that mustn't move.
+		**/
+		void _zoom_at( float _new_zoom_level, const sf::Vector2f& _pivot );
+
+		/**
+		* @brief Update the transform drawing the pixels on the canvas, and everything drawn in canvas space, after a change of the zoom level or the position of the image.
+		**/
+		void _update_image_transform();
 		void _update_pixel_grid();
 
 		//
@@ -123,13 +166,42 @@ namespace Pixeler
 		void _convert_image_colors();
 
 		//
-		// Get the corresponding pixel index to the given quad index.
-		// Quad index: id of the quad in the vertex array. 0 is the first quad created/used in the picture.
-		// Pixel index: id of the pixel in the image, transparent pixels included. 0 is the very first pixel at the top left of the picture.
+		// Give their new colors to the pixels from the given conversion result
 		//
-		uint32_t get_pixel_index( uint32_t _quad_index );
-		PixelDesc* get_pixel_desc( uint32_t _quad_index );
-		PixelDesc* _get_pixel_desc_in_direction( const PixelDesc& _pixel, Direction _direction );
+		void _apply_conversion_result( const ConversionResult& _result );
+
+		/**
+		* @brief Give their palette color to the pixels of some distinct colors of a conversion, and build the tiles containing them again once they are visible.
+		* @param [in] _result				The conversion the distinct colors belong to.
+		* @param [in] _distinct_colors		The distinct colors whose pixels changed of palette color.
+		* @param [in] _nb_palette_colors	The number of colors of the palette used for the conversion.
+		**/
+		void _apply_distinct_colors( const ConversionResult& _result, std::span< const uint32_t > _distinct_colors, size_t _nb_palette_colors );
+
+		/**
+		* @brief Get the palette of the displayed conversion. It is looked up by name each time, as adding or removing palettes moves them.
+		* @return A pointer to the palette, nullptr if the image isn't converted or the palette has been deleted.
+		**/
+		const ColorPalette* _get_palette() const;
+
+		/**
+		* @brief Get the displayed color of each palette index from the palette of the displayed conversion.
+		**/
+		void _update_palette_colors();
+
+		/**
+		* @brief Get the palette color of a pixel.
+		* @param _pixel_index Index of the pixel in the image.
+		* @return A pointer to the color in the palette of the displayed conversion, nullptr if the pixel has none.
+		**/
+		const ColorInfos* _get_color_infos( uint32_t _pixel_index ) const;
+
+		/**
+		* @brief Get the index of a color in the palette of the displayed conversion.
+		* @param _color The color to find.
+		* @return The index of the color in the palette colors vector, PixelStore::Invalid_Index if it isn't part of it.
+		**/
+		uint16_t _get_palette_index( const ColorInfos& _color ) const;
 		//
 		// Get the local position of the mouse on the canvas.
 		//
@@ -139,50 +211,85 @@ namespace Pixeler
 		uint32_t _get_1D_index( const PixelPosition& _pixel_position ) const;
 		PixelPosition _get_2D_position( uint32_t _1D_index ) const;
 
-		void _get_colored_pixels_in_area( uint32_t _pixel_index, const ColorInfos& _area_color, PixelDescsPtr& _pixel_area, std::vector< uint32_t >& _treated_indexes );
+		/**
+		* @brief Label the areas of the converted image again if its palette indices changed since they were last labeled.
+		**/
+		void _update_area_labels();
 
 		/**
 		* @brief Retrieve all same colored pixels as the one at the given index.
-		* @param _pixel_index Index in the pixel descs array.
+		* @param _pixel_index Index of the pixel in the image.
 		**/
 		void _compute_pixel_area( uint32_t _pixel_index );
 
 		/**
 		* @brief Retrieve all same colored pixels as the given color.
 		* @warning This function is not meant to be called first, it is called by the two others of the same name that set up some variables first.
-		* @param _area_color The color to find in the pixel descs array.
-		* @param _treated_indexes An array containing all the previously checked pixel indexes.
+		* @param _area_palette_index The index in the palette colors vector of the color to find in the pixels.
 		**/
-		void _compute_pixel_area( const ColorInfos& _area_color, std::vector< uint32_t >& _treated_indexes );
+		void _compute_pixel_area( uint16_t _area_palette_index );
 
 		void _compute_area_outline();
 		bool _is_pixel_in_current_area( uint32_t _pixel_index ) const;
 
 		///////////////// IMGUI /////////////////
 		void _display_canvas( const sf::Color& _bg_color );
+
+		/**
+		* @brief Draw the image, the grid, the outlines and the minimap in the render texture displayed on the canvas.
+		* @param _bg_color The background color of the canvas.
+		**/
+		void _draw_canvas( const sf::Color& _bg_color );
+		void _mouse_zoom_and_pan();
+
+		/**
+		* @brief Get the transform drawing the whole image in the minimap, at the bottom right corner of the canvas.
+		**/
+		sf::Transform _get_minimap_transform() const;
+
+		/**
+		* @brief Draw an overview of the converted image at the bottom right corner of the canvas, with the part of it visible on the canvas.
+		* @param _bg_color The background color of the canvas.
+		**/
+		void _draw_minimap( const sf::Color& _bg_color );
+
+		/**
+		* @brief Center the canvas on the point of the image clicked in the minimap.
+		* @return True if the mouse is over the minimap, in which case it isn't over the image.
+		**/
+		bool _minimap_navigation();
 		void _mouse_detection();
 		void _display_bottom_bar();
 
 		sf::RenderTexture				m_render_texture;
-		sf::Sprite						m_default_image_sprite;
+		RenderSettings					m_render_settings;		// the settings m_render_texture was last drawn with
+		bool							m_canvas_outdated{ true };	// the image, its conversion or its position changed since m_render_texture was last drawn
+		uint64_t						m_nb_skipped_frames{ 0 };	// the number of frames displaying m_render_texture without drawing it again
 
 		sf::RenderTexture				m_test_texture;
 		sf::Sprite						m_test_image_sprite;
 
 		sf::Sprite						m_sprite;
-		sf::VertexArray					m_base_pixels;			// pixels created from the base image with its colors
-		sf::VertexArray					m_converted_pixels;		// pixels converted from the base ones using a given palette
-		PixelDescs						m_pixels_descs;
+		CanvasTiles						m_tiles;				// textures of the visible parts of the base and converted images and of their reduced levels, in image space (one unit per pixel)
+		sf::Transform					m_image_transform;		// zoom and position of the image on the canvas, applied to the tiles when drawing them
+		PixelStore						m_pixels;
+		std::unique_ptr< ImageLoadJob >	m_load_job;				// the image being loaded, displayed in place of the current one once finished
+		std::vector< std::unique_ptr< ImageLoadJob > > m_cancelled_load_jobs;	// the cancelled jobs whose thread is still running, only destroyed once finished so the UI never waits for them
+		std::string						m_palette_name;			// the name of the palette of the conversion displayed on the canvas, the pixels palette indices refer to its colors
+		std::vector< sf::Color >		m_palette_colors;		// the displayed color of each palette index, which differs from the palette while one of its colors is edited
+		uint8_t							m_original_opacity{ 255 };	// the opacity of the original image drawn over the converted one
 
 		sf::Vector2u					m_image_size{ 0, 0 };
 		ImVec2							m_canvas_size{};
 		sf::FloatRect					m_image_float_rect{ -1.f, -1.f, -1.f, -1.f };
 		float							m_zoom_level{ 1.f };
-		std::array< sf::Vector2f, 4 >	m_offsets;
 		sf::Vector2f					m_image_offest{};
 
 		uint32_t						m_last_hovered_pixel_index{ Uint32_Max };
 		HoveredColor					m_hovered_color;
+		AreaLabels						m_area_labels;			// the areas of the converted image, labeled once per conversion
+		OutlineCache					m_outline_cache;		// the contours of the last outlined areas, in image space so they survive zooming and panning
+		bool							m_area_labels_outdated{ false };	// the palette indices have been edited since the areas were labeled
 
 		sf::RenderTexture				m_grid_texture;
 		sf::Sprite						m_grid_sprite;
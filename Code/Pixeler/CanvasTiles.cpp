@@ -0,0 +1,502 @@
+#include <algorithm>
+#include <cmath>
+
+#include <SFML/Graphics/Sprite.hpp>
+
+#include "CanvasTiles.h"
+#include "Utils.h"
+
+
+namespace Pixeler
+{
+	static constexpr int Resident_Tiles_Margin{ 1 };			// The tiles this close to the visible ones keep their textures, so a small move doesn't build them again.
+	static constexpr size_t Min_Pixels_Per_Task{ 65536 };		// Below this number of pixels, reducing a level on another thread costs more than it saves.
+
+	/**
+	* @brief Call a function on each row of a level, splitting the rows between several threads.
+	* @param [in] _size		The size of the level, in pixels.
+	* @param [in] _row_fct		The function to call with the index of each row.
+	* @param [in] _stop_token	The remaining rows are skipped once it asks to stop.
+	**/
+	template< typename RowFunction >
+	static void for_each_row( const sf::Vector2u& _size, RowFunction&& _row_fct, std::stop_token _stop_token = {} )
+	{
+		const size_t nb_tasks{ std::min< size_t >( Utils::get_nb_tasks( static_cast< size_t >( _size.x ) * _size.y, Min_Pixels_Per_Task ), _size.y ) };
+
+		Utils::parallel_for( _size.y, nb_tasks, [&]( size_t /*_task*/, size_t _first_row, size_t _last_row )
+		{
+			for( size_t row{ _first_row }; row < _last_row && _stop_token.stop_requested() == false; ++row )
+				_row_fct( static_cast< uint32_t >( row ) );
+		} );
+	}
+
+	/**
+	* @brief Reduce the base colors of a level by half: each new pixel is the average of the opaque ones among the 2x2 pixels it covers.
+	* @param [in] _colors			The colors of the level to reduce.
+	* @param [in] _size			The size of the level to reduce.
+	* @param [out] _reduced_colors	The colors of the reduced level.
+	* @param [in] _reduced_size	The size of the reduced level, half the other one rounded up.
+	* @param [in] _stop_token		The remaining rows are skipped once it asks to stop.
+	**/
+	static void reduce_base_colors( std::span< const sf::Color > _colors, const sf::Vector2u& _size, std::span< sf::Color > _reduced_colors, const sf::Vector2u& _reduced_size, std::stop_token _stop_token )
+	{
+		for_each_row( _reduced_size, [&]( uint32_t _row )
+		{
+			for( uint32_t column{ 0 }; column < _reduced_size.x; ++column )
+			{
+				uint32_t sums[ ColorChannel::COUNT ]{ 0, 0, 0, 0 };
+				uint32_t nb_opaque_pixels{ 0 };
+
+				for( uint32_t y{ _row * 2 }; y < std::min( _row * 2 + 2, _size.y ); ++y )
+				{
+					for( uint32_t x{ column * 2 }; x < std::min( column * 2 + 2, _size.x ); ++x )
+					{
+						const sf::Color& color{ _colors[ static_cast< size_t >( y ) * _size.x + x ] };
+
+						if( color.a < Min_Pixel_Alpha )
+							continue;
+
+						sums[ ColorChannel::red ] += color.r;
+						sums[ ColorChannel::green ] += color.g;
+						sums[ ColorChannel::blue ] += color.b;
+						sums[ ColorChannel::alpha ] += color.a;
+						++nb_opaque_pixels;
+					}
+				}
+
+				auto average = [&]( ColorChannel _channel ) { return static_cast< sf::Uint8 >( ( sums[ _channel ] + nb_opaque_pixels / 2 ) / nb_opaque_pixels ); };
+
+				_reduced_colors[ static_cast< size_t >( _row ) * _reduced_size.x + column ] = nb_opaque_pixels > 0
+					? sf::Color{ average( ColorChannel::red ), average( ColorChannel::green ), average( ColorChannel::blue ), average( ColorChannel::alpha ) }
+					: sf::Color::Transparent;
+			}
+		}, _stop_token );
+	}
+
+	/**
+	* @brief Reduce the palette indices of a tile of a level by half: each new pixel takes the most frequent valid index among the 2x2 pixels it covers, the lowest one in case of a tie.
+	* Averaging them would give colors that aren't part of the palette.
+	* @param [in] _indices			The palette indices of the level to reduce.
+	* @param [in] _size			The size of the level to reduce.
+	* @param [out] _reduced_indices	The palette indices of the reduced level.
+	* @param [in] _reduced_size	The size of the reduced level, half the other one rounded up.
+	* @param [in] _tile_rect		The part of the reduced level to compute.
+	**/
+	static void reduce_palette_indices( std::span< const uint16_t > _indices, const sf::Vector2u& _size, std::span< uint16_t > _reduced_indices, const sf::Vector2u& _reduced_size, const sf::IntRect& _tile_rect )
+	{
+		const uint32_t last_row{ static_cast< uint32_t >( _tile_rect.top + _tile_rect.height ) };
+		const uint32_t last_column{ static_cast< uint32_t >( _tile_rect.left + _tile_rect.width ) };
+
+		for( uint32_t row{ static_cast< uint32_t >( _tile_rect.top ) }; row < last_row; ++row )
+		{
+			for( uint32_t column{ static_cast< uint32_t >( _tile_rect.left ) }; column < last_column; ++column )
+			{
+				uint16_t covered_indices[ 4 ];
+				uint32_t nb_covered_indices{ 0 };
+
+				for( uint32_t y{ row * 2 }; y < std::min( row * 2 + 2, _size.y ); ++y )
+				{
+					for( uint32_t x{ column * 2 }; x < std::min( column * 2 + 2, _size.x ); ++x )
+					{
+						const uint16_t palette_index{ _indices[ static_cast< size_t >( y ) * _size.x + x ] };
+
+						if( palette_index != PixelStore::Invalid_Index )
+							covered_indices[ nb_covered_indices++ ] = palette_index;
+					}
+				}
+
+				uint16_t most_frequent_index{ PixelStore::Invalid_Index };
+				uint32_t best_count{ 0 };
+
+				for( uint32_t index{ 0 }; index < nb_covered_indices; ++index )
+				{
+					const uint32_t count{ static_cast< uint32_t >( std::count( covered_indices, covered_indices + nb_covered_indices, covered_indices[ index ] ) ) };
+
+					if( count > best_count || ( count == best_count && covered_indices[ index ] < most_frequent_index ) )
+					{
+						most_frequent_index = covered_indices[ index ];
+						best_count = count;
+					}
+				}
+
+				_reduced_indices[ static_cast< size_t >( row ) * _reduced_size.x + column ] = most_frequent_index;
+			}
+		}
+	}
+
+	/**
+	* @brief Release all the tiles, split the given image in new ones and build its reduced levels.
+	* @param [in] _pixels		The pixels of the image.
+	* @param [in] _stop_token	The token of the loading thread, checked between the rows of the reduced levels.
+	* @return False if the token asked to stop, the tiles are then left empty.
+	**/
+	bool CanvasTiles::reset( const PixelStore& _pixels, std::stop_token _stop_token /*= {}*/ )
+	{
+		m_levels.clear();
+		m_resident_tiles.clear();
+		m_displayed_level = 0;
+		m_converted_levels_outdated = true;
+
+		sf::Vector2u size{ _pixels.get_size() };
+
+		if( size.x == 0 || size.y == 0 )
+			return true;
+
+		m_levels.emplace_back().m_size = size;
+
+		// The most reduced level fits in a single tile, it is used as an overview of the image.
+		while( std::max( size.x, size.y ) > Tile_Size )
+		{
+			size = { ( size.x + 1 ) / 2, ( size.y + 1 ) / 2 };
+
+			Level& level{ m_levels.emplace_back() };
+			const Level& previous_level{ m_levels[ m_levels.size() - 2 ] };
+			const size_t nb_pixels{ static_cast< size_t >( size.x ) * size.y };
+
+			level.m_size = size;
+			level.m_base_colors.resize( nb_pixels );
+			level.m_palette_indices.assign( nb_pixels, PixelStore::Invalid_Index );
+
+			reduce_base_colors( m_levels.size() == 2 ? _pixels.get_base_colors() : previous_level.m_base_colors, previous_level.m_size, level.m_base_colors, level.m_size, _stop_token );
+
+			if( _stop_token.stop_requested() )
+			{
+				m_levels.clear();
+				return false;
+			}
+		}
+
+		for( Level& level : m_levels )
+		{
+			level.m_nb_tiles = { ( level.m_size.x + Tile_Size - 1 ) / Tile_Size, ( level.m_size.y + Tile_Size - 1 ) / Tile_Size };
+			level.m_tiles.resize( static_cast< size_t >( level.m_nb_tiles.x ) * level.m_nb_tiles.y );
+		}
+
+		return true;
+	}
+
+	/**
+	* @brief Build the converted textures of all the tiles again the next time they are visible, after a new conversion.
+	**/
+	void CanvasTiles::invalidate_converted()
+	{
+		for( Level& level : m_levels )
+		{
+			for( Tile& tile : level.m_tiles )
+			{
+				tile.m_converted_outdated = true;
+				tile.m_palette_indices_outdated = true;
+			}
+		}
+
+		m_converted_levels_outdated = true;
+	}
+
+	/**
+	* @brief Build the converted textures of the tiles containing the given pixel again the next time they are visible.
+	* Only the tiles of the reduced levels containing the pixel will have their palette indices reduced again.
+	* @param [in] _pixel The index of the pixel in the image, transparent pixels included.
+	**/
+	void CanvasTiles::invalidate_converted_pixel( size_t _pixel )
+	{
+		if( m_levels.empty() )
+			return;
+
+		const size_t x{ _pixel % m_levels.front().m_size.x };
+		const size_t y{ _pixel / m_levels.front().m_size.x };
+
+		for( size_t level_index{ 0 }; level_index < m_levels.size(); ++level_index )
+		{
+			Level& level{ m_levels[ level_index ] };
+			const size_t tile{ ( ( y >> level_index ) / Tile_Size ) * level.m_nb_tiles.x + ( x >> level_index ) / Tile_Size };
+
+			if( tile < level.m_tiles.size() )
+			{
+				level.m_tiles[ tile ].m_converted_outdated = true;
+				level.m_tiles[ tile ].m_palette_indices_outdated = true;
+			}
+		}
+
+		m_converted_levels_outdated = true;
+	}
+
+	/**
+	* @brief Choose the level matching the zoom level, create the textures of its tiles intersecting the visible part of the image, and release the textures of the other tiles.
+	* The tile of the most reduced level is always kept, to draw the overview of the image.
+	* @param [in] _visible_rect	The visible part of the image, in pixels.
+	* @param [in] _zoom_level		The size of a pixel on the canvas.
+	* @param [in] _pixels			The pixels of the image.
+	* @param [in] _palette_colors	The displayed color of each palette index of the pixels.
+	**/
+	void CanvasTiles::update( const sf::FloatRect& _visible_rect, float _zoom_level, const PixelStore& _pixels, std::span< const sf::Color > _palette_colors )
+	{
+		if( m_levels.empty() || _pixels.get_size() != m_levels.front().m_size )
+			return;
+
+		if( m_converted_levels_outdated )
+		{
+			_build_converted_levels( _pixels );
+			m_converted_levels_outdated = false;
+		}
+
+		const size_t level_index{ _get_level_index( _zoom_level ) };
+		const size_t overview_level_index{ m_levels.size() - 1 };
+		const Level& level{ m_levels[ level_index ] };
+		const float level_scale{ static_cast< float >( 1u << level_index ) };
+
+		auto to_tile = []( float _position, uint32_t _nb_tiles ) -> int
+		{
+			return std::clamp( static_cast< int >( std::floor( _position / Tile_Size ) ), 0, static_cast< int >( _nb_tiles ) - 1 );
+		};
+
+		const int first_column{ std::max( to_tile( _visible_rect.left / level_scale, level.m_nb_tiles.x ) - Resident_Tiles_Margin, 0 ) };
+		const int last_column{ std::min( to_tile( ( _visible_rect.left + _visible_rect.width ) / level_scale, level.m_nb_tiles.x ) + Resident_Tiles_Margin, static_cast< int >( level.m_nb_tiles.x ) - 1 ) };
+		const int first_row{ std::max( to_tile( _visible_rect.top / level_scale, level.m_nb_tiles.y ) - Resident_Tiles_Margin, 0 ) };
+		const int last_row{ std::min( to_tile( ( _visible_rect.top + _visible_rect.height ) / level_scale, level.m_nb_tiles.y ) + Resident_Tiles_Margin, static_cast< int >( level.m_nb_tiles.y ) - 1 ) };
+
+		auto is_resident = [&]( uint32_t _tile )
+		{
+			const int column{ static_cast< int >( _tile % level.m_nb_tiles.x ) };
+			const int row{ static_cast< int >( _tile / level.m_nb_tiles.x ) };
+
+			return column >= first_column && column <= last_column && row >= first_row && row <= last_row;
+		};
+
+		// All the tiles of the previous level are released when the zoom level changes enough to display another one, except the overview.
+		for( const uint32_t tile : m_resident_tiles )
+		{
+			if( ( m_displayed_level == level_index && is_resident( tile ) ) || m_displayed_level == overview_level_index )
+				continue;
+
+			m_levels[ m_displayed_level ].m_tiles[ tile ].m_base_texture.reset();
+			m_levels[ m_displayed_level ].m_tiles[ tile ].m_converted_texture.reset();
+		}
+
+		m_resident_tiles.clear();
+		m_displayed_level = level_index;
+
+		for( int row{ first_row }; row <= last_row; ++row )
+		{
+			for( int column{ first_column }; column <= last_column; ++column )
+			{
+				const uint32_t tile_index{ static_cast< uint32_t >( row ) * level.m_nb_tiles.x + static_cast< uint32_t >( column ) };
+
+				m_resident_tiles.push_back( tile_index );
+				_update_tile( level_index, tile_index, _pixels, _palette_colors );
+			}
+		}
+
+		_update_tile( overview_level_index, 0, _pixels, _palette_colors );
+	}
+
+	/**
+	* @brief Draw the visible tiles of a layer.
+	* @param [in] _target		The target to draw the tiles on.
+	* @param [in] _transform	The transform from image space, where a pixel is a square of size 1, to the target.
+	* @param [in] _layer		The layer to draw.
+	* @param [in] _color		The color multiplied with the pixels colors, to change their opacity.
+	**/
+	void CanvasTiles::draw( sf::RenderTarget& _target, const sf::Transform& _transform, Layer _layer, const sf::Color& _color /*= sf::Color::White*/ ) const
+	{
+		_draw_tiles( _target, _transform, m_displayed_level, m_resident_tiles, _layer, _color );
+	}
+
+	/**
+	* @brief Draw the whole image from its most reduced level.
+	* @param [in] _target		The target to draw the image on.
+	* @param [in] _transform	The transform from image space, where a pixel is a square of size 1, to the target.
+	* @param [in] _layer		The layer to draw.
+	**/
+	void CanvasTiles::draw_overview( sf::RenderTarget& _target, const sf::Transform& _transform, Layer _layer ) const
+	{
+		if( m_levels.empty() )
+			return;
+
+		static constexpr uint32_t overview_tile{ 0 };
+
+		_draw_tiles( _target, _transform, m_levels.size() - 1, { &overview_tile, 1 }, _layer, sf::Color::White );
+	}
+
+	/**
+	* @brief Get the level to draw for the given zoom level: the most reduced one whose pixels are still at least as big as the pixels of the canvas.
+	* @param [in] _zoom_level The size of a pixel of the image on the canvas.
+	**/
+	size_t CanvasTiles::_get_level_index( float _zoom_level ) const
+	{
+		if( m_levels.empty() || _zoom_level >= 1.f || _zoom_level <= 0.f )
+			return 0;
+
+		const int level_index{ static_cast< int >( std::floor( std::log2( 1.f / _zoom_level ) ) ) };
+
+		return std::min( static_cast< size_t >( std::max( level_index, 0 ) ), m_levels.size() - 1 );
+	}
+
+	/**
+	* @brief Compute the most frequent palette index of the outdated tiles of the reduced levels from the palette index plane of the image.
+	* The levels are reduced from the biggest to the smallest, so the pixels a tile covers in the previous level are already up to date.
+	* @param [in] _pixels The pixels of the image.
+	**/
+	void CanvasTiles::_build_converted_levels( const PixelStore& _pixels )
+	{
+		std::vector< uint32_t > outdated_tiles;
+
+		for( size_t level_index{ 1 }; level_index < m_levels.size(); ++level_index )
+		{
+			const Level& previous_level{ m_levels[ level_index - 1 ] };
+			Level& level{ m_levels[ level_index ] };
+			const std::span< const uint16_t > previous_indices{ level_index == 1 ? _pixels.get_palette_indices() : std::span< const uint16_t >{ previous_level.m_palette_indices } };
+
+			outdated_tiles.clear();
+
+			for( uint32_t tile_index{ 0 }; tile_index < level.m_tiles.size(); ++tile_index )
+			{
+				if( level.m_tiles[ tile_index ].m_palette_indices_outdated )
+					outdated_tiles.push_back( tile_index );
+			}
+
+			const size_t nb_tasks{ std::min( Utils::get_nb_tasks( outdated_tiles.size() * Tile_Size * Tile_Size, Min_Pixels_Per_Task ), outdated_tiles.size() ) };
+
+			// Each task reduces whole tiles, which don't share any pixel.
+			Utils::parallel_for( outdated_tiles.size(), nb_tasks, [&]( size_t /*_task*/, size_t _first_tile, size_t _last_tile )
+			{
+				for( size_t tile{ _first_tile }; tile < _last_tile; ++tile )
+					reduce_palette_indices( previous_indices, previous_level.m_size, level.m_palette_indices, level.m_size, _get_tile_rect( level, outdated_tiles[ tile ] ) );
+			} );
+
+			for( const uint32_t tile_index : outdated_tiles )
+				level.m_tiles[ tile_index ].m_palette_indices_outdated = false;
+		}
+	}
+
+	/**
+	* @brief Create the missing or outdated textures of a tile.
+	* @param [in] _level_index		The index of the level of the tile.
+	* @param [in] _tile_index		The index of the tile in its level, row by row.
+	* @param [in] _pixels			The pixels of the image.
+	* @param [in] _palette_colors	The displayed color of each palette index of the pixels.
+	**/
+	void CanvasTiles::_update_tile( size_t _level_index, size_t _tile_index, const PixelStore& _pixels, std::span< const sf::Color > _palette_colors )
+	{
+		Level& level{ m_levels[ _level_index ] };
+		Tile& tile{ level.m_tiles[ _tile_index ] };
+		const sf::IntRect tile_rect{ _get_tile_rect( level, _tile_index ) };
+
+		// The first level reads the planes of the pixel store.
+		const std::span< const sf::Color > base_colors{ _level_index == 0 ? _pixels.get_base_colors() : std::span< const sf::Color >{ level.m_base_colors } };
+		const std::span< const uint16_t > palette_indices{ _level_index == 0 ? _pixels.get_palette_indices() : std::span< const uint16_t >{ level.m_palette_indices } };
+
+		if( tile.m_base_texture == nullptr )
+		{
+			tile.m_base_texture = std::make_unique< sf::Texture >();
+			tile.m_base_texture->create( tile_rect.width, tile_rect.height );
+
+			_fill_texture( *tile.m_base_texture, level.m_size.x, tile_rect, [&]( size_t _pixel )
+			{
+				return base_colors[ _pixel ].a >= Min_Pixel_Alpha ? base_colors[ _pixel ] : sf::Color::Transparent;
+			} );
+		}
+
+		if( tile.m_converted_texture == nullptr || tile.m_converted_outdated )
+		{
+			if( tile.m_converted_texture == nullptr )
+			{
+				tile.m_converted_texture = std::make_unique< sf::Texture >();
+				tile.m_converted_texture->create( tile_rect.width, tile_rect.height );
+			}
+
+			// Pixels without palette color keep their base color.
+			_fill_texture( *tile.m_converted_texture, level.m_size.x, tile_rect, [&]( size_t _pixel )
+			{
+				if( base_colors[ _pixel ].a < Min_Pixel_Alpha )
+					return sf::Color::Transparent;
+
+				const uint16_t palette_index{ palette_indices[ _pixel ] };
+				return palette_index < _palette_colors.size() ? _palette_colors[ palette_index ] : base_colors[ _pixel ];
+			} );
+
+			tile.m_converted_outdated = false;
+		}
+	}
+
+	/**
+	* @brief Get the part of a level covered by a tile.
+	* @param [in] _level	The level of the tile.
+	* @param [in] _tile	The index of the tile in its level, row by row.
+	**/
+	sf::IntRect CanvasTiles::_get_tile_rect( const Level& _level, size_t _tile )
+	{
+		const uint32_t left{ static_cast< uint32_t >( _tile % _level.m_nb_tiles.x ) * Tile_Size };
+		const uint32_t top{ static_cast< uint32_t >( _tile / _level.m_nb_tiles.x ) * Tile_Size };
+
+		return { static_cast< int >( left ), static_cast< int >( top ), static_cast< int >( std::min( Tile_Size, _level.m_size.x - left ) ), static_cast< int >( std::min( Tile_Size, _level.m_size.y - top ) ) };
+	}
+
+	/**
+	* @brief Draw the tiles of a layer.
+	* @param [in] _target		The target to draw the tiles on.
+	* @param [in] _transform	The transform from image space to the target.
+	* @param [in] _level_index	The level of the tiles.
+	* @param [in] _tiles		The indices of the tiles in their level.
+	* @param [in] _layer		The layer to draw.
+	* @param [in] _color		The color multiplied with the pixels colors.
+	**/
+	void CanvasTiles::_draw_tiles( sf::RenderTarget& _target, const sf::Transform& _transform, size_t _level_index, std::span< const uint32_t > _tiles, Layer _layer, const sf::Color& _color ) const
+	{
+		if( _level_index >= m_levels.size() )
+			return;
+
+		const Level& level{ m_levels[ _level_index ] };
+
+		// A pixel of a level covers 2^level pixels of the image in each direction.
+		sf::Transform level_transform{ _transform };
+		level_transform.scale( static_cast< float >( 1u << _level_index ), static_cast< float >( 1u << _level_index ) );
+
+		for( const uint32_t tile_index : _tiles )
+		{
+			const Tile& tile{ level.m_tiles[ tile_index ] };
+			const sf::Texture* texture{ _layer == Layer::base ? tile.m_base_texture.get() : tile.m_converted_texture.get() };
+
+			if( texture == nullptr )
+				continue;
+
+			const sf::IntRect tile_rect{ _get_tile_rect( level, tile_index ) };
+			sf::Sprite sprite{ *texture };
+
+			sprite.setPosition( static_cast< float >( tile_rect.left ), static_cast< float >( tile_rect.top ) );
+			sprite.setColor( _color );
+
+			_target.draw( sprite, level_transform );
+		}
+	}
+
+	/**
+	* @brief Fill a texture with the colors of the pixels of a tile.
+	* @param [in] _texture		The texture to fill, created with the size of the tile.
+	* @param [in] _level_width	The width of the level of the tile, in pixels.
+	* @param [in] _tile_rect		The part of the level covered by the tile.
+	* @param [in] _get_color		The function giving the displayed color of a pixel from its index in the level.
+	**/
+	template< typename ColorFunction >
+	void CanvasTiles::_fill_texture( sf::Texture& _texture, uint32_t _level_width, const sf::IntRect& _tile_rect, ColorFunction&& _get_color )
+	{
+		m_tile_pixels.resize( static_cast< size_t >( _tile_rect.width ) * _tile_rect.height * ColorChannel::COUNT );
+		sf::Uint8* tile_pixel{ m_tile_pixels.data() };
+
+		for( int y{ 0 }; y < _tile_rect.height; ++y )
+		{
+			const size_t first_pixel{ static_cast< size_t >( _tile_rect.top + y ) * _level_width + _tile_rect.left };
+
+			for( size_t pixel{ first_pixel }; pixel < first_pixel + _tile_rect.width; ++pixel, tile_pixel += ColorChannel::COUNT )
+			{
+				const sf::Color color{ _get_color( pixel ) };
+
+				tile_pixel[ ColorChannel::red ]		= color.r;
+				tile_pixel[ ColorChannel::green ]	= color.g;
+				tile_pixel[ ColorChannel::blue ]	= color.b;
+				tile_pixel[ ColorChannel::alpha ]	= color.a;
+			}
+		}
+
+		_texture.update( m_tile_pixels.data() );
+	}
+} // namespace Pixeler
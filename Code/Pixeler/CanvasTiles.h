@@ -0,0 +1,163 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <stop_token>
+#include <vector>
+
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Texture.hpp>
+
+#include "PixelStore.h"
+
+
+namespace Pixeler
+{
+	/************************************************************************
+	* @brief The image displayed on the canvas, split in square tiles. The textures of a tile are only created while it is visible, and released once it isn't anymore.
+	* They are views of the pixel store, the base colors for the original image and the palette index plane for the converted one, so they can be dropped and built again at any time.
+	* The image is also reduced by half as many times as needed to fit in a single tile. The reduced levels are drawn when zooming out, so a texel is never much smaller than a pixel of the canvas.
+	************************************************************************/
+	class CanvasTiles
+	{
+	public:
+		static constexpr uint32_t Tile_Size{ 128 };		// The width and height of a tile, in pixels.
+
+		enum class Layer
+		{
+			base,			// The colors of the pixels before the conversion.
+			converted,		// The palette colors given to the pixels by the conversion.
+		};
+
+		/**
+		* @brief Release all the tiles, split the given image in new ones and build its reduced levels.
+		* @param [in] _pixels		The pixels of the image.
+		* @param [in] _stop_token	The token of the loading thread, checked between the rows of the reduced levels.
+		* @return False if the token asked to stop, the tiles are then left empty.
+		**/
+		bool reset( const PixelStore& _pixels, std::stop_token _stop_token = {} );
+
+		/**
+		* @brief Build the converted textures of all the tiles again the next time they are visible, after a new conversion.
+		**/
+		void invalidate_converted();
+
+		/**
+		* @brief Build the converted textures of the tiles containing the given pixel again the next time they are visible.
+		* Only the tiles of the reduced levels containing the pixel will have their palette indices reduced again.
+		* @param [in] _pixel The index of the pixel in the image, transparent pixels included.
+		**/
+		void invalidate_converted_pixel( size_t _pixel );
+
+		/**
+		* @brief Choose the level matching the zoom level, create the textures of its tiles intersecting the visible part of the image, and release the textures of the other tiles.
+		* The tile of the most reduced level is always kept, to draw the overview of the image.
+		* @param [in] _visible_rect	The visible part of the image, in pixels.
+		* @param [in] _zoom_level		The size of a pixel on the canvas.
+		* @param [in] _pixels			The pixels of the image.
+		* @param [in] _palette_colors	The displayed color of each palette index of the pixels.
+		**/
+		void update( const sf::FloatRect& _visible_rect, float _zoom_level, const PixelStore& _pixels, std::span< const sf::Color > _palette_colors );
+
+		/**
+		* @brief Draw the visible tiles of a layer.
+		* @param [in] _target		The target to draw the tiles on.
+		* @param [in] _transform	The transform from image space, where a pixel is a square of size 1, to the target.
+		* @param [in] _layer		The layer to draw.
+		* @param [in] _color		The color multiplied with the pixels colors, to change their opacity.
+		**/
+		void draw( sf::RenderTarget& _target, const sf::Transform& _transform, Layer _layer, const sf::Color& _color = sf::Color::White ) const;
+
+		/**
+		* @brief Draw the whole image from its most reduced level.
+		* @param [in] _target		The target to draw the image on.
+		* @param [in] _transform	The transform from image space, where a pixel is a square of size 1, to the target.
+		* @param [in] _layer		The layer to draw.
+		**/
+		void draw_overview( sf::RenderTarget& _target, const sf::Transform& _transform, Layer _layer ) const;
+
+		size_t get_nb_levels() const { return m_levels.size(); }
+		size_t get_displayed_level() const { return m_displayed_level; }
+		size_t get_nb_resident_tiles() const { return m_resident_tiles.size(); }
+
+	private:
+		/************************************************************************
+		* @brief The textures of a part of the image, empty while it isn't visible.
+		************************************************************************/
+		struct Tile
+		{
+			std::unique_ptr< sf::Texture >	m_base_texture;
+			std::unique_ptr< sf::Texture >	m_converted_texture;
+			bool							m_converted_outdated{ true };		// The palette colors of some pixels of the tile changed since its converted texture was built.
+			bool							m_palette_indices_outdated{ true };	// The palette indices of the pixels the tile covers in the previous level changed since they were reduced.
+		};
+
+		/************************************************************************
+		* @brief The image reduced by a power of two and its tiles. Each pixel of a level covers 2x2 pixels of the previous one.
+		* The first level is the image itself, its planes are read from the pixel store instead of being copied.
+		************************************************************************/
+		struct Level
+		{
+			sf::Vector2u				m_size{ 0, 0 };							// The size of the level, in pixels.
+			sf::Vector2u				m_nb_tiles{ 0, 0 };						// The number of tiles in a row and in a column.
+			std::vector< Tile >			m_tiles;								// The tiles of the level, row by row.
+			std::vector< sf::Color >	m_base_colors;							// The average color of the opaque pixels of the previous level covered by each pixel, transparent if there is none.
+			std::vector< uint16_t >		m_palette_indices;						// The most frequent palette index of the pixels of the previous level covered by each pixel, so the palette colors stay exact.
+		};
+
+		/**
+		* @brief Get the level to draw for the given zoom level: the most reduced one whose pixels are still at least as big as the pixels of the canvas.
+		* @param [in] _zoom_level The size of a pixel of the image on the canvas.
+		**/
+		size_t _get_level_index( float _zoom_level ) const;
+
+		/**
+		* @brief Compute the most frequent palette index of the outdated tiles of the reduced levels from the palette index plane of the image.
+		* @param [in] _pixels The pixels of the image.
+		**/
+		void _build_converted_levels( const PixelStore& _pixels );
+
+		/**
+		* @brief Create the missing or outdated textures of a tile.
+		* @param [in] _level_index		The index of the level of the tile.
+		* @param [in] _tile_index		The index of the tile in its level, row by row.
+		* @param [in] _pixels			The pixels of the image.
+		* @param [in] _palette_colors	The displayed color of each palette index of the pixels.
+		**/
+		void _update_tile( size_t _level_index, size_t _tile_index, const PixelStore& _pixels, std::span< const sf::Color > _palette_colors );
+
+		/**
+		* @brief Get the part of a level covered by a tile.
+		* @param [in] _level	The level of the tile.
+		* @param [in] _tile	The index of the tile in its level, row by row.
+		**/
+		static sf::IntRect _get_tile_rect( const Level& _level, size_t _tile );
+
+		/**
+		* @brief Draw the tiles of a layer.
+		* @param [in] _target		The target to draw the tiles on.
+		* @param [in] _transform	The transform from image space to the target.
+		* @param [in] _level_index	The level of the tiles.
+		* @param [in] _tiles		The indices of the tiles in their level.
+		* @param [in] _layer		The layer to draw.
+		* @param [in] _color		The color multiplied with the pixels colors.
+		**/
+		void _draw_tiles( sf::RenderTarget& _target, const sf::Transform& _transform, size_t _level_index, std::span< const uint32_t > _tiles, Layer _layer, const sf::Color& _color ) const;
+
+		/**
+		* @brief Fill a texture with the colors of the pixels of a tile.
+		* @param [in] _texture		The texture to fill, created with the size of the tile.
+		* @param [in] _level_width	The width of the level of the tile, in pixels.
+		* @param [in] _tile_rect		The part of the level covered by the tile.
+		* @param [in] _get_color		The function giving the displayed color of a pixel from its index in the level.
+		**/
+		template< typename ColorFunction >
+		void _fill_texture( sf::Texture& _texture, uint32_t _level_width, const sf::IntRect& _tile_rect, ColorFunction&& _get_color );
+
+		std::vector< Level >		m_levels;								// The image and its reduced versions, from the biggest to the smallest.
+		std::vector< uint32_t >		m_resident_tiles;						// The tiles of the displayed level having textures, the visible ones and those around them.
+		size_t						m_displayed_level{ 0 };					// The level matching the current zoom level.
+		bool						m_converted_levels_outdated{ true };	// The palette indices of some tiles of the reduced levels have to be computed again.
+		std::vector< sf::Uint8 >	m_tile_pixels;							// The colors of the pixels of the tile being built, kept to avoid an allocation per tile.
+	};
+} // namespace Pixeler
@@ -0,0 +1,77 @@
+#include <algorithm>
+
+#include <FZN/Tools/Logging.h>
+
+#include "ColorCandidates.h"
+#include "PaletteSnapshot.h"
+#include "Utils.h"
+
+
+namespace Pixeler
+{
+	static constexpr size_t Max_Candidates{ 1 << 24 };		// The number of candidates kept for all the colors together, 32MB.
+	static constexpr size_t Max_Candidates_Per_Color{ 8 };	// Ranking more candidates costs more than searching the few colors having none of them selected among the selected colors.
+	static constexpr size_t Min_Colors_Per_Task{ 1024 };	// Below this number of colors to rank, starting another thread costs more than it saves.
+
+	/**
+	* @brief Rank the palette colors for each of the given colors.
+	* @param [in] _snapshot	A snapshot of all the colors of the palette, selected or not. It determines the distance used to rank the colors.
+	* @param [in] _palette		The palette the snapshot was built from.
+	* @param [in] _colors		The colors to rank the palette colors for.
+	**/
+	void ColorCandidates::build( const PaletteSnapshot& _snapshot, const ColorPalette& _palette, std::span< const sf::Color > _colors )
+	{
+		const size_t nb_palette_colors{ _snapshot.get_nb_colors() };
+
+		m_palette = &_palette;
+		m_colors_signature = _palette.compute_colors_signature();
+		m_distance = _snapshot.get_distance();
+		m_nb_colors = _colors.size();
+		m_nb_candidates = std::min( std::clamp< size_t >( Max_Candidates / std::max< size_t >( m_nb_colors, 1 ), 1, Max_Candidates_Per_Color ), nb_palette_colors );
+		m_all_candidates = m_nb_candidates == nb_palette_colors;
+		m_candidates.resize( m_nb_colors * m_nb_candidates );
+
+		Utils::parallel_for( m_nb_colors, Utils::get_nb_tasks( m_nb_colors, Min_Colors_Per_Task ), [&]( size_t /*_task*/, size_t _first_color, size_t _last_color )
+		{
+			_snapshot.rank_colors( _colors.subspan( _first_color, _last_color - _first_color ), m_nb_candidates, std::span{ m_candidates }.subspan( _first_color * m_nb_candidates, ( _last_color - _first_color ) * m_nb_candidates ) );
+		} );
+
+		FZN_DBLOG( "Ranked %zu candidates out of %zu palette colors for %zu colors.", m_nb_candidates, nb_palette_colors, m_nb_colors );
+	}
+
+	/**
+	* @brief Check if the candidates have been ranked with the current colors of the given palette and the given distance.
+	* @param [in] _palette		The palette to check.
+	* @param [in] _distance	The distance to check.
+	* @return True if the candidates can be used to convert colors with this palette and distance.
+	**/
+	bool ColorCandidates::is_built_for( const ColorPalette& _palette, ColorDistance _distance ) const
+	{
+		if( m_palette != &_palette || m_distance != _distance )
+			return false;
+
+		return m_colors_signature == _palette.compute_colors_signature();
+	}
+
+	/**
+	* @brief Find the closest selected color to one of the colors.
+	* @param [in] _color		The index of the color in the list given to build.
+	* @param [in] _selection	The selection state of each palette color, 0 for unselected colors.
+	* @return The index of the closest selected color in the palette colors vector, Invalid_Index if no color is selected, Unresolved_Index if no candidate of the color is selected.
+	**/
+	uint16_t ColorCandidates::find_color_index( size_t _color, std::span< const uint8_t > _selection ) const
+	{
+		if( _color >= m_nb_colors )
+			return Unresolved_Index;
+
+		const uint16_t* candidates{ m_candidates.data() + _color * m_nb_candidates };
+
+		for( size_t candidate{ 0 }; candidate < m_nb_candidates; ++candidate )
+		{
+			if( candidates[ candidate ] < _selection.size() && _selection[ candidates[ candidate ] ] != 0 )
+				return candidates[ candidate ];
+		}
+
+		return m_all_candidates ? Invalid_Index : Unresolved_Index;
+	}
+} // namespace Pixeler
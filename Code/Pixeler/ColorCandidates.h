@@ -0,0 +1,63 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <SFML/Graphics/Color.hpp>
+
+#include "ColorPalette.h"
+
+
+namespace Pixeler
+{
+	class PaletteSnapshot;
+
+	/************************************************************************
+	* @brief The closest palette colors of a list of colors, sorted by distance, whether they are selected or not.
+	* The closest selected color of a list color is its first selected candidate, so a new selection of the palette colors doesn't require to compute any distance.
+	* Only a few candidates are kept per color, even less when there are so many colors that the whole list wouldn't fit in a fixed budget.
+	* When none of the candidates of a color is selected, its closest color has to be searched among the selected colors again.
+	************************************************************************/
+	class ColorCandidates
+	{
+	public:
+		static constexpr uint16_t Invalid_Index{ std::numeric_limits< uint16_t >::max() };	// The color has no candidate because no palette color is selected.
+		static constexpr uint16_t Unresolved_Index{ Invalid_Index - 1 };						// None of the candidates of the color is selected, but other palette colors are.
+
+		/**
+		* @brief Rank the palette colors for each of the given colors.
+		* @param [in] _snapshot	A snapshot of all the colors of the palette, selected or not. It determines the distance used to rank the colors.
+		* @param [in] _palette		The palette the snapshot was built from.
+		* @param [in] _colors		The colors to rank the palette colors for.
+		**/
+		void build( const PaletteSnapshot& _snapshot, const ColorPalette& _palette, std::span< const sf::Color > _colors );
+
+		/**
+		* @brief Check if the candidates have been ranked with the current colors of the given palette and the given distance.
+		* @param [in] _palette		The palette to check.
+		* @param [in] _distance	The distance to check.
+		* @return True if the candidates can be used to convert colors with this palette and distance.
+		**/
+		bool is_built_for( const ColorPalette& _palette, ColorDistance _distance ) const;
+
+		/**
+		* @brief Find the closest selected color to one of the colors.
+		* @param [in] _color		The index of the color in the list given to build.
+		* @param [in] _selection	The selection state of each palette color, 0 for unselected colors.
+		* @return The index of the closest selected color in the palette colors vector, Invalid_Index if no color is selected, Unresolved_Index if no candidate of the color is selected.
+		**/
+		uint16_t find_color_index( size_t _color, std::span< const uint8_t > _selection ) const;
+
+		size_t get_nb_colors() const { return m_nb_colors; }
+		size_t get_nb_candidates() const { return m_nb_candidates; }
+
+	private:
+		std::vector< uint16_t >		m_candidates;							// The palette indices of the candidates of each color, m_nb_candidates per color.
+		size_t						m_nb_colors{ 0 };						// The number of ranked colors.
+		size_t						m_nb_candidates{ 0 };					// The number of candidates kept for each color.
+		bool						m_all_candidates{ false };				// All the palette colors are candidates, so colors can't be unresolved.
+		const ColorPalette*			m_palette{ nullptr };					// The palette used for the last build.
+		uint64_t					m_colors_signature{ 0 };				// The signature of the palette colors at the time of the last build.
+		ColorDistance				m_distance{ ColorDistance::RGB };		// The distance used to rank the colors.
+	};
+} // namespace Pixeler
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <utility>
+
+#include "ColorSpaces.h"
+
+
+namespace Pixeler::Metric
+{
+	/************************************************************************
+	* @brief Compile-time policies of the color distances. The conversion loops are templated on them, so each distance gets its own inlined loop and is chosen once per conversion instead of once per color.
+	* Each policy gives the ColorDistance it implements, the distance between two sets of coordinates (identical to ColorSpaces::get_distance),
+	* and a lower bound of this distance, which is never bigger than it and lets a search skip the colors that can't be closer than the closest one found so far.
+	************************************************************************/
+
+	/************************************************************************
+	* @brief Squared euclidean distance between the coordinates of the colors. RGB, OKLab and CIE76 only differ by their coordinates.
+	************************************************************************/
+	template< ColorDistance _distance >
+	struct Euclidean
+	{
+		static constexpr ColorDistance	Distance{ _distance };
+		static constexpr bool			Use_Lower_Bound{ false };		// The bound costs almost as much as the distance and would prevent the loops from being vectorized.
+
+		static float get_distance( const ImVec4& _color_a, const ImVec4& _color_b ) { return ColorSpaces::get_squared_distance( _color_a, _color_b ); }
+
+		/**
+		* @brief The first term of the sum, adding the other ones can't make it smaller.
+		**/
+		static float get_lower_bound( const ImVec4& _color_a, const ImVec4& _color_b ) { return fzn::Math::Square( _color_b.x - _color_a.x ); }
+	};
+
+	using RGB	= Euclidean< ColorDistance::RGB >;
+	using OKLab = Euclidean< ColorDistance::OKLab >;
+	using CIE76 = Euclidean< ColorDistance::CIE76 >;
+
+	/************************************************************************
+	* @brief RGB distance weighted according to the mean red of both colors.
+	************************************************************************/
+	struct Redmean
+	{
+		static constexpr ColorDistance	Distance{ ColorDistance::Redmean };
+		static constexpr bool			Use_Lower_Bound{ false };
+		static constexpr float			Base_Weight{ ColorSpaces::Redmean_Base_Weight };
+		static constexpr float			Green_Weight{ ColorSpaces::Redmean_Green_Weight };
+		static constexpr float			Red_Scale{ ColorSpaces::Redmean_Red_Scale };
+
+		static float get_distance( const ImVec4& _color_a, const ImVec4& _color_b ) { return ColorSpaces::get_redmean_distance( _color_a, _color_b ); }
+
+		/**
+		* @brief The green term of the sum, its weight being constant.
+		**/
+		static float get_lower_bound( const ImVec4& _color_a, const ImVec4& _color_b ) { return Green_Weight * fzn::Math::Square( _color_b.y - _color_a.y ); }
+	};
+
+	/************************************************************************
+	* @brief Squared CIEDE2000 difference. It is so expensive that skipping the colors too far in lightness is worth an additional test.
+	************************************************************************/
+	struct CIE2000
+	{
+		static constexpr ColorDistance	Distance{ ColorDistance::CIE2000 };
+		static constexpr bool			Use_Lower_Bound{ true };
+		static constexpr float			Lower_Bound_Margin{ 0.999f };	// Keeps the bound under the distance despite the rounding errors of the full computation.
+
+		static float get_distance( const ImVec4& _color_a, const ImVec4& _color_b ) { return ColorSpaces::get_ciede2000_distance( _color_a, _color_b ); }
+
+		/**
+		* @brief The lightness term of the difference. The chroma and hue terms can't make the sum smaller than it, as the rotation term is smaller than twice their product.
+		**/
+		static float get_lower_bound( const ImVec4& _color_a, const ImVec4& _color_b )
+		{
+			const float lightness_from_50{ fzn::Math::Square( ( _color_a.x + _color_b.x ) * 0.5f - 50.f ) };
+			const float lightness_weight{ 1.f + 0.015f * lightness_from_50 / std::sqrt( 20.f + lightness_from_50 ) };
+
+			return fzn::Math::Square( ( _color_b.x - _color_a.x ) / lightness_weight ) * Lower_Bound_Margin;
+		}
+	};
+
+	/**
+	* @brief Call the given function with the policy of the given distance. This is the only place where the distance is checked, the function being instantiated for each policy.
+	* @param [in] _distance	The distance to use.
+	* @param [in] _function	A generic callable taking a policy object as parameter.
+	* @return What the function returns.
+	**/
+	template< typename Function >
+	decltype( auto ) dispatch( ColorDistance _distance, Function&& _function )
+	{
+		switch( _distance )
+		{
+			case ColorDistance::Redmean:	return std::forward< Function >( _function )( Redmean{} );
+			case ColorDistance::OKLab:		return std::forward< Function >( _function )( OKLab{} );
+			case ColorDistance::CIE76:		return std::forward< Function >( _function )( CIE76{} );
+			case ColorDistance::CIE2000:	return std::forward< Function >( _function )( CIE2000{} );
+			default:						return std::forward< Function >( _function )( RGB{} );
+		}
+	}
+} // namespace Pixeler::Metric
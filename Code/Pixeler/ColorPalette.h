@@ -1,11 +1,14 @@
 #pragma once
 
+#include <bit>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include <FZN/Tools/Tools.h>
+#include <FZN/Tools/Math.h>
 
+#include "ColorSpaces.h"
 #include "Defines.h"
 #include "Utils.h"
 
@@ -70,10 +73,35 @@ namespace Pixeler
 			return color_name;
 		}
 
+		/**
+		* @brief Compute the values of the color in the perceptual color spaces. Must be called each time m_color changes.
+		**/
+		void update_color_spaces()
+		{
+			m_oklab = ColorSpaces::to_oklab( m_color );
+			m_cielab = ColorSpaces::to_cielab( m_color );
+		}
+
+		/**
+		* @brief Get the values of the color compared by the given distance.
+		**/
+		const ImVec4& get_coordinates( ColorDistance _distance ) const
+		{
+			switch( _distance )
+			{
+				case ColorDistance::OKLab:		return m_oklab;
+				case ColorDistance::CIE76:
+				case ColorDistance::CIE2000:	return m_cielab;
+				default:						return m_color.Value;
+			}
+		}
+
 		ColorID				m_color_id;
 		ImColor				m_color{ -1, -1, -1, -1 };
 		bool				m_selected{ true };
-		int					m_count{ -1 };				// if -1, convertion hasn't been done yet
+
+		ImVec4				m_oklab;					// m_color in OKLab color space, updated by update_color_spaces.
+		ImVec4				m_cielab;					// m_color in CIELAB color space, updated by update_color_spaces.
 	};
 	using ColorInfosVector = std::vector< ColorInfos >;
 	
@@ -97,6 +125,18 @@ namespace Pixeler
 		bool is_using_IDs() const { return m_nb_digits_in_IDs > 0; }
 		bool is_using_names() const { return m_using_names; }
 
+		/**
+		* @brief Compute a value identifying the colors of the palette and their selection. It changes as soon as a color is edited, added, removed, selected or unselected.
+		* @return The signature of the current state of the palette colors.
+		**/
+		uint64_t compute_selection_signature() const { return _compute_signature( true ); }
+
+		/**
+		* @brief Compute a value identifying the colors of the palette, whether they are selected or not. It changes as soon as a color is edited, added or removed.
+		* @return The signature of the current palette colors.
+		**/
+		uint64_t compute_colors_signature() const { return _compute_signature( false ); }
+
 		std::string			m_name;
 		std::string			m_file_path;
 		ColorInfosVector	m_colors;
@@ -104,10 +144,58 @@ namespace Pixeler
 
 		uint8_t				m_nb_digits_in_IDs{ 0 };
 		bool				m_using_names{ true };
+
+	private:
+		/**
+		* @brief Hash the colors of the palette with FNV-1a.
+		* @param [in] _with_selection Include the selection of the colors, the unselected colors only adding their selection state.
+		* @return The signature of the palette colors.
+		**/
+		uint64_t _compute_signature( bool _with_selection ) const
+		{
+			uint64_t signature{ 14695981039346656037ull };
+
+			auto add_value = [&signature]( uint64_t _value )
+			{
+				signature ^= _value;
+				signature *= 1099511628211ull;
+			};
+
+			add_value( m_colors.size() );
+
+			for( const ColorInfos& color : m_colors )
+			{
+				if( _with_selection )
+				{
+					add_value( color.m_selected );
+
+					if( color.m_selected == false )
+						continue;
+				}
+
+				add_value( std::bit_cast< uint32_t >( color.m_color.Value.x ) );
+				add_value( std::bit_cast< uint32_t >( color.m_color.Value.y ) );
+				add_value( std::bit_cast< uint32_t >( color.m_color.Value.z ) );
+			}
+
+			return signature;
+		}
 	};
 	using ColorPalettes = std::vector< ColorPalette >;
 
 
+	/**
+	* @brief Compute the squared distance between two colors. This is the value compared to find the closest palette color to a pixel.
+	* @param [in] _color_a The first color.
+	* @param [in] _color_b The second color.
+	* @return The sum of the squared differences of the red, green and blue channels.
+	**/
+	inline float get_color_distance( const ImColor& _color_a, const ImColor& _color_b )
+	{
+		return ColorSpaces::get_squared_distance( _color_a.Value, _color_b.Value );
+	}
+
+
 	/**
 	* @brief Sorting function for palettes presets. Preset "All" will always be first.
 	* @param [in] _preset_a The first preset to sort.
@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+
+#include "ColorSpaces.h"
+
+
+namespace Pixeler::ColorSpaces
+{
+	static constexpr size_t Batch_Size{ 64 };		// Number of colors converted together, one step and one channel at a time, so the compiler can vectorize the loops.
+
+	static float srgb_to_linear( float _value )
+	{
+		return _value <= 0.04045f ? _value / 12.92f : std::pow( ( _value + 0.055f ) / 1.055f, 2.4f );
+	}
+
+	/**
+	* @brief Get the linear value of each of the 256 possible values of an 8 bits sRGB channel.
+	**/
+	static const std::array< float, 256 >& get_linear_values()
+	{
+		static const std::array< float, 256 > linear_values{ []()
+		{
+			std::array< float, 256 > values;
+
+			for( size_t value{ 0 }; value < values.size(); ++value )
+				values[ value ] = srgb_to_linear( value / 255.f );
+
+			return values;
+		}() };
+
+		return linear_values;
+	}
+
+	/**
+	* @brief Convert a batch of linear RGB colors to OKLab. Values from https://bottosson.github.io/posts/oklab/
+	**/
+	static void linear_to_oklab( const float* _reds, const float* _greens, const float* _blues, size_t _nb_colors, ImVec4* _coordinates )
+	{
+		float long_cones[ Batch_Size ];
+		float medium_cones[ Batch_Size ];
+		float short_cones[ Batch_Size ];
+
+		for( size_t color{ 0 }; color < _nb_colors; ++color )
+		{
+			long_cones[ color ] = 0.4122214708f * _reds[ color ] + 0.5363325363f * _greens[ color ] + 0.0514459929f * _blues[ color ];
+			medium_cones[ color ] = 0.2119034982f * _reds[ color ] + 0.6806995451f * _greens[ color ] + 0.1073969566f * _blues[ color ];
+			short_cones[ color ] = 0.0883024619f * _reds[ color ] + 0.2817188376f * _greens[ color ] + 0.6299787005f * _blues[ color ];
+		}
+
+		for( size_t color{ 0 }; color < _nb_colors; ++color )
+		{
+			long_cones[ color ] = std::cbrt( long_cones[ color ] );
+			medium_cones[ color ] = std::cbrt( medium_cones[ color ] );
+			short_cones[ color ] = std::cbrt( short_cones[ color ] );
+		}
+
+		for( size_t color{ 0 }; color < _nb_colors; ++color )
+		{
+			_coordinates[ color ].x = 0.2104542553f * long_cones[ color ] + 0.7936177850f * medium_cones[ color ] - 0.0040720468f * short_cones[ color ];
+			_coordinates[ color ].y = 1.9779984951f * long_cones[ color ] - 2.4285922050f * medium_cones[ color ] + 0.4505937099f * short_cones[ color ];
+			_coordinates[ color ].z = 0.0259040371f * long_cones[ color ] + 0.7827717662f * medium_cones[ color ] - 0.8086757660f * short_cones[ color ];
+			_coordinates[ color ].w = 1.f;
+		}
+	}
+
+	/**
+	* @brief Convert a batch of linear RGB colors to CIELAB, using the D65 white point.
+	**/
+	static void linear_to_cielab( const float* _reds, const float* _greens, const float* _blues, size_t _nb_colors, ImVec4* _coordinates )
+	{
+		static constexpr float Epsilon{ 216.f / 24389.f };		// ( 6 / 29 )^3
+		static constexpr float Kappa{ 24389.f / 27.f };			// ( 29 / 3 )^3
+
+		// XYZ values, divided by the ones of the white point.
+		float x_values[ Batch_Size ];
+		float y_values[ Batch_Size ];
+		float z_values[ Batch_Size ];
+
+		for( size_t color{ 0 }; color < _nb_colors; ++color )
+		{
+			x_values[ color ] = ( 0.4124564f * _reds[ color ] + 0.3575761f * _greens[ color ] + 0.1804375f * _blues[ color ] ) * ( 1.f / 0.95047f );
+			y_values[ color ] = 0.2126729f * _reds[ color ] + 0.7151522f * _greens[ color ] + 0.0721750f * _blues[ color ];
+			z_values[ color ] = ( 0.0193339f * _reds[ color ] + 0.1191920f * _greens[ color ] + 0.9503041f * _blues[ color ] ) * ( 1.f / 1.08883f );
+		}
+
+		auto lab_function = []( float _value )
+		{
+			return _value > Epsilon ? std::cbrt( _value ) : ( Kappa * _value + 16.f ) / 116.f;
+		};
+
+		for( size_t color{ 0 }; color < _nb_colors; ++color )
+		{
+			x_values[ color ] = lab_function( x_values[ color ] );
+			y_values[ color ] = lab_function( y_values[ color ] );
+			z_values[ color ] = lab_function( z_values[ color ] );
+		}
+
+		for( size_t color{ 0 }; color < _nb_colors; ++color )
+		{
+			_coordinates[ color ].x = 116.f * y_values[ color ] - 16.f;
+			_coordinates[ color ].y = 500.f * ( x_values[ color ] - y_values[ color ] );
+			_coordinates[ color ].z = 200.f * ( y_values[ color ] - z_values[ color ] );
+			_coordinates[ color ].w = 1.f;
+		}
+	}
+
+	/**
+	* @brief Convert a color to the OKLab color space.
+	* @param [in] _color The color to convert, its channels being sRGB values between 0 and 1.
+	* @return The L, a and b values of the color in x, y and z.
+	**/
+	ImVec4 to_oklab( const ImColor& _color )
+	{
+		const float red{ srgb_to_linear( _color.Value.x ) };
+		const float green{ srgb_to_linear( _color.Value.y ) };
+		const float blue{ srgb_to_linear( _color.Value.z ) };
+
+		ImVec4 oklab;
+		linear_to_oklab( &red, &green, &blue, 1, &oklab );
+
+		return oklab;
+	}
+
+	/**
+	* @brief Convert a color to the CIELAB color space, using the D65 white point.
+	* @param [in] _color The color to convert, its channels being sRGB values between 0 and 1.
+	* @return The L*, a* and b* values of the color in x, y and z.
+	**/
+	ImVec4 to_cielab( const ImColor& _color )
+	{
+		const float red{ srgb_to_linear( _color.Value.x ) };
+		const float green{ srgb_to_linear( _color.Value.y ) };
+		const float blue{ srgb_to_linear( _color.Value.z ) };
+
+		ImVec4 cielab;
+		linear_to_cielab( &red, &green, &blue, 1, &cielab );
+
+		return cielab;
+	}
+
+	/**
+	* @brief Convert a list of colors to the values compared by the given distance. The colors are processed in batches, one channel at a time.
+	* @param [in]	_distance		The distance that will be used to compare the colors.
+	* @param [in]	_colors			The colors to convert.
+	* @param [out]	_coordinates	The converted colors. Must be as big as _colors.
+	**/
+	void get_coordinates( ColorDistance _distance, std::span< const sf::Color > _colors, std::span< ImVec4 > _coordinates )
+	{
+		const size_t nb_colors{ std::min( _colors.size(), _coordinates.size() ) };
+
+		if( _distance == ColorDistance::RGB || _distance == ColorDistance::Redmean )
+		{
+			// Same values as Utils::to_imcolor.
+			for( size_t color{ 0 }; color < nb_colors; ++color )
+				_coordinates[ color ] = { _colors[ color ].r / 255.f, _colors[ color ].g / 255.f, _colors[ color ].b / 255.f, 1.f };
+
+			return;
+		}
+
+		const std::array< float, 256 >& linear_values{ get_linear_values() };
+
+		float reds[ Batch_Size ];
+		float greens[ Batch_Size ];
+		float blues[ Batch_Size ];
+
+		for( size_t first_color{ 0 }; first_color < nb_colors; first_color += Batch_Size )
+		{
+			const size_t batch_size{ std::min( Batch_Size, nb_colors - first_color ) };
+
+			for( size_t color{ 0 }; color < batch_size; ++color )
+			{
+				reds[ color ] = linear_values[ _colors[ first_color + color ].r ];
+				greens[ color ] = linear_values[ _colors[ first_color + color ].g ];
+				blues[ color ] = linear_values[ _colors[ first_color + color ].b ];
+			}
+
+			if( _distance == ColorDistance::OKLab )
+				linear_to_oklab( reds, greens, blues, batch_size, &_coordinates[ first_color ] );
+			else
+				linear_to_cielab( reds, greens, blues, batch_size, &_coordinates[ first_color ] );
+		}
+	}
+
+	/**
+	* @brief Convert a single color to the values compared by the given distance. Gives the same result as the list version.
+	**/
+	ImVec4 get_coordinates( ColorDistance _distance, const sf::Color& _color )
+	{
+		ImVec4 coordinates;
+		get_coordinates( _distance, { &_color, 1 }, { &coordinates, 1 } );
+
+		return coordinates;
+	}
+
+	/**
+	* @brief Compute the squared CIEDE2000 difference between two colors.
+	* Formula from "The CIEDE2000 Color-Difference Formula: Implementation Notes, Supplementary Test Data, and Mathematical Observations" (Sharma, Wu, Dalal).
+	* @param [in] _color_a The CIELAB values of the first color.
+	* @param [in] _color_b The CIELAB values of the second color.
+	**/
+	float get_ciede2000_distance( const ImVec4& _color_a, const ImVec4& _color_b )
+	{
+		static constexpr float Pow_25_7{ 6103515625.f };		// 25^7
+		static constexpr float To_Radians{ std::numbers::pi_v< float > / 180.f };
+
+		auto get_hue = []( float _b, float _a_prime )
+		{
+			if( _b == 0.f && _a_prime == 0.f )
+				return 0.f;
+
+			const float hue{ std::atan2( _b, _a_prime ) / To_Radians };
+			return hue < 0.f ? hue + 360.f : hue;
+		};
+
+		const float chroma_a{ std::sqrt( _color_a.y * _color_a.y + _color_a.z * _color_a.z ) };
+		const float chroma_b{ std::sqrt( _color_b.y * _color_b.y + _color_b.z * _color_b.z ) };
+		const float mean_chroma_7{ std::pow( ( chroma_a + chroma_b ) * 0.5f, 7.f ) };
+		const float g{ 0.5f * ( 1.f - std::sqrt( mean_chroma_7 / ( mean_chroma_7 + Pow_25_7 ) ) ) };
+
+		const float a_prime_a{ ( 1.f + g ) * _color_a.y };
+		const float a_prime_b{ ( 1.f + g ) * _color_b.y };
+		const float chroma_prime_a{ std::sqrt( a_prime_a * a_prime_a + _color_a.z * _color_a.z ) };
+		const float chroma_prime_b{ std::sqrt( a_prime_b * a_prime_b + _color_b.z * _color_b.z ) };
+		const float hue_prime_a{ get_hue( _color_a.z, a_prime_a ) };
+		const float hue_prime_b{ get_hue( _color_b.z, a_prime_b ) };
+		const bool no_chroma{ chroma_prime_a * chroma_prime_b == 0.f };
+
+		const float delta_lightness{ _color_b.x - _color_a.x };
+		const float delta_chroma{ chroma_prime_b - chroma_prime_a };
+
+		float delta_hue{ 0.f };
+
+		if( no_chroma == false )
+		{
+			delta_hue = hue_prime_b - hue_prime_a;
+
+			if( delta_hue > 180.f )
+				delta_hue -= 360.f;
+			else if( delta_hue < -180.f )
+				delta_hue += 360.f;
+		}
+
+		const float delta_hue_big{ 2.f * std::sqrt( chroma_prime_a * chroma_prime_b ) * std::sin( delta_hue * 0.5f * To_Radians ) };
+
+		const float mean_lightness{ ( _color_a.x + _color_b.x ) * 0.5f };
+		const float mean_chroma_prime{ ( chroma_prime_a + chroma_prime_b ) * 0.5f };
+
+		float mean_hue{ hue_prime_a + hue_prime_b };
+
+		if( no_chroma == false )
+		{
+			if( std::abs( hue_prime_a - hue_prime_b ) <= 180.f )
+				mean_hue *= 0.5f;
+			else if( mean_hue < 360.f )
+				mean_hue = ( mean_hue + 360.f ) * 0.5f;
+			else
+				mean_hue = ( mean_hue - 360.f ) * 0.5f;
+		}
+
+		const float t{ 1.f - 0.17f * std::cos( ( mean_hue - 30.f ) * To_Radians ) + 0.24f * std::cos( 2.f * mean_hue * To_Radians ) + 0.32f * std::cos( ( 3.f * mean_hue + 6.f ) * To_Radians ) - 0.20f * std::cos( ( 4.f * mean_hue - 63.f ) * To_Radians ) };
+		const float delta_theta{ 30.f * std::exp( -fzn::Math::Square( ( mean_hue - 275.f ) / 25.f ) ) };
+		const float mean_chroma_prime_7{ std::pow( mean_chroma_prime, 7.f ) };
+		const float rotation_chroma{ 2.f * std::sqrt( mean_chroma_prime_7 / ( mean_chroma_prime_7 + Pow_25_7 ) ) };
+		const float lightness_from_50{ fzn::Math::Square( mean_lightness - 50.f ) };
+
+		const float lightness_weight{ 1.f + 0.015f * lightness_from_50 / std::sqrt( 20.f + lightness_from_50 ) };
+		const float chroma_weight{ 1.f + 0.045f * mean_chroma_prime };
+		const float hue_weight{ 1.f + 0.015f * mean_chroma_prime * t };
+		const float rotation{ -std::sin( 2.f * delta_theta * To_Radians ) * rotation_chroma };
+
+		const float lightness_term{ delta_lightness / lightness_weight };
+		const float chroma_term{ delta_chroma / chroma_weight };
+		const float hue_term{ delta_hue_big / hue_weight };
+
+		return lightness_term * lightness_term + chroma_term * chroma_term + hue_term * hue_term + rotation * chroma_term * hue_term;
+	}
+} // namespace Pixeler::ColorSpaces
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <span>
+
+#include <Externals/ImGui/imgui.h>
+#include <SFML/Graphics/Color.hpp>
+
+#include <FZN/Tools/Math.h>
+
+
+namespace Pixeler
+{
+	/************************************************************************
+	* @brief The ways of measuring the difference between two colors, used to find the closest palette color to a pixel.
+	************************************************************************/
+	enum class ColorDistance : uint8_t
+	{
+		RGB,			// Squared euclidean distance between the red, green and blue channels.
+		Redmean,		// RGB distance weighted according to the mean red value of both colors, a cheap approximation of human perception.
+		OKLab,			// Squared euclidean distance in the OKLab color space.
+		CIE76,			// Squared euclidean distance in the CIELAB color space (Delta E 1976).
+		CIE2000,		// Squared CIEDE2000 color difference, computed from CIELAB values.
+		COUNT
+	};
+
+	static constexpr const char* ColorDistance_Names[]{ "RGB", "Redmean", "OKLab", "CIELAB dE76", "CIELAB dE2000" };
+
+	namespace ColorSpaces
+	{
+		/**
+		* @brief Convert a color to the OKLab color space.
+		* @param [in] _color The color to convert, its channels being sRGB values between 0 and 1.
+		* @return The L, a and b values of the color in x, y and z.
+		**/
+		ImVec4 to_oklab( const ImColor& _color );
+
+		/**
+		* @brief Convert a color to the CIELAB color space, using the D65 white point.
+		* @param [in] _color The color to convert, its channels being sRGB values between 0 and 1.
+		* @return The L*, a* and b* values of the color in x, y and z.
+		**/
+		ImVec4 to_cielab( const ImColor& _color );
+
+		/**
+		* @brief Convert a list of colors to the values compared by the given distance. The colors are processed in batches, one channel at a time.
+		* @param [in]	_distance		The distance that will be used to compare the colors.
+		* @param [in]	_colors			The colors to convert.
+		* @param [out]	_coordinates	The converted colors. Must be as big as _colors.
+		**/
+		void get_coordinates( ColorDistance _distance, std::span< const sf::Color > _colors, std::span< ImVec4 > _coordinates );
+
+		/**
+		* @brief Convert a single color to the values compared by the given distance. Gives the same result as the list version.
+		**/
+		ImVec4 get_coordinates( ColorDistance _distance, const sf::Color& _color );
+
+		/**
+		* @brief Check if the given distance is the squared euclidean distance between the coordinates of the colors.
+		**/
+		inline bool is_euclidean( ColorDistance _distance ) { return _distance == ColorDistance::RGB || _distance == ColorDistance::OKLab || _distance == ColorDistance::CIE76; }
+
+		/**
+		* @brief Compute the squared euclidean distance between two sets of coordinates.
+		* @param [in] _color_a The coordinates of the first color.
+		* @param [in] _color_b The coordinates of the second color.
+		**/
+		inline float get_squared_distance( const ImVec4& _color_a, const ImVec4& _color_b )
+		{
+			return fzn::Math::Square( _color_b.x - _color_a.x ) + fzn::Math::Square( _color_b.y - _color_a.y ) + fzn::Math::Square( _color_b.z - _color_a.z );
+		}
+
+		inline constexpr float Redmean_Base_Weight{ 2.f };			// Weight of the red and blue differences, before adding the part depending on the mean red.
+		inline constexpr float Redmean_Green_Weight{ 4.f };			// Weight of the green difference.
+		inline constexpr float Redmean_Red_Scale{ 1.f / 256.f };	// Part of the mean red (or of its complement for blue) added to the red (or blue) weight.
+
+		/**
+		* @brief Compute the redmean distance between two colors.
+		* @param [in] _color_a The first color, its channels being between 0 and 1.
+		* @param [in] _color_b The second color, its channels being between 0 and 1.
+		**/
+		inline float get_redmean_distance( const ImVec4& _color_a, const ImVec4& _color_b )
+		{
+			// The mean red is expressed between 0 and 255 as in the original formula, the distance itself stays in the [0, 1] range of the channels.
+			const float mean_red{ ( _color_a.x + _color_b.x ) * 0.5f * 255.f };
+			const float red_weight{ Redmean_Base_Weight + mean_red * Redmean_Red_Scale };
+			const float blue_weight{ Redmean_Base_Weight + ( 255.f - mean_red ) * Redmean_Red_Scale };
+
+			return red_weight * fzn::Math::Square( _color_b.x - _color_a.x ) + Redmean_Green_Weight * fzn::Math::Square( _color_b.y - _color_a.y ) + blue_weight * fzn::Math::Square( _color_b.z - _color_a.z );
+		}
+
+		/**
+		* @brief Compute the squared CIEDE2000 difference between two colors.
+		* @param [in] _color_a The CIELAB values of the first color.
+		* @param [in] _color_b The CIELAB values of the second color.
+		**/
+		float get_ciede2000_distance( const ImVec4& _color_a, const ImVec4& _color_b );
+
+		/**
+		* @brief Compute the difference between two colors with the given distance. Only used to compare differences, the smaller the closer.
+		* @param [in] _distance	The distance to use.
+		* @param [in] _color_a		The coordinates of the first color, as given by get_coordinates.
+		* @param [in] _color_b		The coordinates of the second color, as given by get_coordinates.
+		**/
+		inline float get_distance( ColorDistance _distance, const ImVec4& _color_a, const ImVec4& _color_b )
+		{
+			switch( _distance )
+			{
+				case ColorDistance::Redmean:	return get_redmean_distance( _color_a, _color_b );
+				case ColorDistance::CIE2000:	return get_ciede2000_distance( _color_a, _color_b );
+				default:						return get_squared_distance( _color_a, _color_b );
+			}
+		}
+	} // namespace ColorSpaces
+} // namespace Pixeler
@@ -0,0 +1,354 @@
+#include <algorithm>
+#include <unordered_map>
+
+#include "ColorMetrics.h"
+#include "ConversionResult.h"
+#include "Defines.h"
+#include "Utils.h"
+
+
+namespace Pixeler
+{
+	static constexpr size_t Min_Pixels_Per_Band{ 65536 };		// Below this number of pixels, handling an image band on its own thread costs more than it saves.
+	static constexpr size_t Min_Colors_Per_Task{ 4096 };		// Below this number of distinct colors, handling them on another thread costs more than it saves.
+
+	/**
+	* @brief List the distinct colors of the given pixels and the number of pixels using each of them. Transparent pixels are ignored.
+	* Alpha doesn't take part in the conversion, so two colors only differing by their alpha are considered the same.
+	* @param [in] _pixels		The colors of all the pixels of the image, row by row.
+	* @param [in] _row_size	The width of the image. The image is split in bands of rows handled by different threads.
+	* @param [in] _nb_bands	The number of bands, 0 to choose it from the size of the image.
+	**/
+	void ConversionResult::gather_colors( std::span< const sf::Color > _pixels, size_t _row_size, size_t _nb_bands /*= 0*/ )
+	{
+		const auto start_time{ std::chrono::steady_clock::now() };
+		auto image_colors{ std::make_shared< ImageColors >() };
+
+		auto get_color_key = []( const sf::Color& _color ) -> uint32_t
+		{
+			return ( _color.r << 16 ) | ( _color.g << 8 ) | _color.b;
+		};
+
+		/************************************************************************
+		* @brief The distinct colors of a band of rows of the image, and the number of pixels using each of them.
+		************************************************************************/
+		struct BandColors
+		{
+			std::unordered_map< uint32_t, uint32_t >	m_unique_colors;		// Index of each distinct color in the following vectors.
+			std::vector< sf::Color >					m_colors;
+			std::vector< int >							m_nb_pixels;
+			std::vector< uint32_t >						m_merged_indices;		// Index of each distinct color of the band among the colors of the whole image.
+			std::vector< uint32_t >						m_next_positions;		// Position in the pixels grouped by color of the next pixel of each distinct color of the band.
+		};
+
+		// Each band lists its own colors and pixel counts, then the bands are merged in order so the colors are listed in the same order as if the image had been read in one go.
+		const size_t row_size{ std::max< size_t >( _row_size, 1 ) };
+		const size_t nb_rows{ _pixels.size() / row_size };
+		const size_t nb_bands{ _nb_bands > 0 ? _nb_bands : Utils::get_nb_tasks( nb_rows, std::max< size_t >( Min_Pixels_Per_Band / row_size, 1 ) ) };
+
+		std::vector< BandColors > bands( nb_bands );
+		std::vector< uint32_t >& pixels_distinct_colors{ image_colors->m_pixels_distinct_colors };
+		pixels_distinct_colors.assign( nb_rows * row_size, Uint32_Max );
+
+		Utils::parallel_for( nb_rows, nb_bands, [&]( size_t _band, size_t _first_row, size_t _last_row )
+		{
+			BandColors& band{ bands[ _band ] };
+			band.m_unique_colors.reserve( 1024 );
+
+			for( size_t pixel{ _first_row * row_size }; pixel < _last_row * row_size; ++pixel )
+			{
+				if( _pixels[ pixel ].a < Min_Pixel_Alpha )
+					continue;
+
+				const auto [ unique_color, inserted ] = band.m_unique_colors.try_emplace( get_color_key( _pixels[ pixel ] ), static_cast< uint32_t >( band.m_colors.size() ) );
+
+				if( inserted )
+				{
+					band.m_colors.push_back( _pixels[ pixel ] );
+					band.m_nb_pixels.push_back( 0 );
+				}
+
+				++band.m_nb_pixels[ unique_color->second ];
+				pixels_distinct_colors[ pixel ] = unique_color->second;
+			}
+		} );
+
+		std::unordered_map< uint32_t, uint32_t > unique_colors;
+		unique_colors.reserve( bands.front().m_colors.size() );
+
+		for( BandColors& band : bands )
+		{
+			band.m_merged_indices.resize( band.m_colors.size() );
+
+			for( size_t band_color{ 0 }; band_color < band.m_colors.size(); ++band_color )
+			{
+				const auto [ unique_color, inserted ] = unique_colors.try_emplace( get_color_key( band.m_colors[ band_color ] ), static_cast< uint32_t >( image_colors->m_distinct_colors.size() ) );
+
+				if( inserted )
+				{
+					image_colors->m_distinct_colors.push_back( band.m_colors[ band_color ] );
+					image_colors->m_distinct_colors_pixels.push_back( 0 );
+				}
+
+				image_colors->m_distinct_colors_pixels[ unique_color->second ] += band.m_nb_pixels[ band_color ];
+				band.m_merged_indices[ band_color ] = unique_color->second;
+			}
+		}
+
+		// The pixels of each color are grouped one after another. Each band writes its pixels after the ones of the previous bands, so they stay in image order.
+		const size_t nb_colors{ image_colors->m_distinct_colors.size() };
+		std::vector< uint32_t >& colors_first_pixel{ image_colors->m_colors_first_pixel };
+		colors_first_pixel.resize( nb_colors + 1 );
+		colors_first_pixel[ 0 ] = 0;
+
+		for( size_t color{ 0 }; color < nb_colors; ++color )
+			colors_first_pixel[ color + 1 ] = colors_first_pixel[ color ] + image_colors->m_distinct_colors_pixels[ color ];
+
+		std::vector< uint32_t > next_positions( colors_first_pixel.begin(), colors_first_pixel.end() - 1 );
+
+		for( BandColors& band : bands )
+		{
+			band.m_next_positions.resize( band.m_colors.size() );
+
+			for( size_t band_color{ 0 }; band_color < band.m_colors.size(); ++band_color )
+			{
+				band.m_next_positions[ band_color ] = next_positions[ band.m_merged_indices[ band_color ] ];
+				next_positions[ band.m_merged_indices[ band_color ] ] += band.m_nb_pixels[ band_color ];
+			}
+		}
+
+		image_colors->m_colors_pixels.resize( colors_first_pixel.back() );
+
+		// The pixels were given the index of their color in their band, they now need its index in the whole image.
+		Utils::parallel_for( nb_rows, nb_bands, [&]( size_t _band, size_t _first_row, size_t _last_row )
+		{
+			BandColors& band{ bands[ _band ] };
+
+			for( size_t pixel{ _first_row * row_size }; pixel < _last_row * row_size; ++pixel )
+			{
+				const uint32_t band_color{ pixels_distinct_colors[ pixel ] };
+
+				if( band_color == Uint32_Max )
+					continue;
+
+				pixels_distinct_colors[ pixel ] = band.m_merged_indices[ band_color ];
+				image_colors->m_colors_pixels[ band.m_next_positions[ band_color ]++ ] = static_cast< uint32_t >( pixel );
+			}
+		} );
+
+		image_colors->m_gathering_time = std::chrono::steady_clock::now() - start_time;
+
+		m_image_colors = std::move( image_colors );
+		m_candidates.reset();
+		_clear_conversion();
+	}
+
+	/**
+	* @brief Use the distinct colors and palette candidates of another result instead of gathering them again.
+	* The conversion of the other result is copied too, so converting the colors again only measures the distances of the ones whose palette color changed.
+	* @param [in] _result The result to share the colors of.
+	**/
+	void ConversionResult::share_colors( const ConversionResult& _result )
+	{
+		m_image_colors = _result.m_image_colors;
+		m_candidates = _result.m_candidates;
+		_clear_conversion();
+
+		if( _result.m_converted == false )
+			return;
+
+		m_colors_palette_indices = _result.m_colors_palette_indices;
+		m_colors_distances = _result.m_colors_distances;
+		m_palette_name = _result.m_palette_name;
+		m_converted = true;
+		m_colors_signature = _result.m_colors_signature;
+		m_distance = _result.m_distance;
+	}
+
+	/**
+	* @brief Keep the palette color found for each distinct color.
+	* If the colors were already converted with the same palette colors and distance, only the colors changing of palette color are measured again and listed in the changed colors.
+	* @param [in] _palette			The palette used for the conversion. Only its name is kept, the palette is looked up by name when its colors are needed.
+	* @param [in] _distance		The distance used to compare the colors.
+	* @param [in] _candidates		The palette candidates of the distinct colors used for the conversion, kept to convert them again with another selection.
+	* @param [in] _palette_indices	The index in the palette colors vector of the closest color to each distinct color, Invalid_Index if there is none.
+	* @param [in] _color_counts	The number of pixels converted to each color of the palette.
+	* @param [in] _conversion_time	The time spent looking for the palette colors.
+	**/
+	void ConversionResult::set_palette_indices( const ColorPalette& _palette, ColorDistance _distance, std::shared_ptr< const ColorCandidates > _candidates, std::span< const uint16_t > _palette_indices, std::vector< int >&& _color_counts, Duration _conversion_time )
+	{
+		const auto start_time{ std::chrono::steady_clock::now() };
+
+		// The distances are kept to find the colors getting closer to a palette color when it is edited.
+		const std::vector< sf::Color >& distinct_colors{ get_distinct_colors() };
+		const size_t nb_colors{ std::min( distinct_colors.size(), _palette_indices.size() ) };
+		const uint64_t colors_signature{ _palette.compute_colors_signature() };
+
+		// With the same palette colors and distance, the colors keeping their palette color also keep their distance.
+		m_changed_colors.clear();
+		m_changed_colors_only = m_converted && m_palette_name == _palette.m_name && m_colors_signature == colors_signature && m_distance == _distance && m_colors_palette_indices.size() == nb_colors;
+
+		if( m_changed_colors_only )
+		{
+			for( uint32_t color{ 0 }; color < nb_colors; ++color )
+			{
+				if( _palette_indices[ color ] != m_colors_palette_indices[ color ] )
+					m_changed_colors.push_back( color );
+			}
+		}
+
+		m_colors_palette_indices.assign( _palette_indices.begin(), _palette_indices.begin() + nb_colors );
+		m_colors_distances.resize( nb_colors );
+
+		const size_t nb_measured_colors{ m_changed_colors_only ? m_changed_colors.size() : nb_colors };
+
+		Metric::dispatch( _distance, [&]< typename DistanceMetric >( DistanceMetric )
+		{
+			Utils::parallel_for( nb_measured_colors, Utils::get_nb_tasks( nb_measured_colors, Min_Colors_Per_Task ), [&]( size_t /*_task*/, size_t _first_color, size_t _last_color )
+			{
+				for( size_t measured_color{ _first_color }; measured_color < _last_color; ++measured_color )
+				{
+					const size_t color{ m_changed_colors_only ? m_changed_colors[ measured_color ] : measured_color };
+					const uint16_t palette_index{ m_colors_palette_indices[ color ] };
+
+					if( palette_index < _palette.m_colors.size() )
+						m_colors_distances[ color ] = DistanceMetric::get_distance( ColorSpaces::get_coordinates( _distance, distinct_colors[ color ] ), _palette.m_colors[ palette_index ].get_coordinates( _distance ) );
+					else
+						m_colors_distances[ color ] = Flt_Max;
+				}
+			} );
+		} );
+
+		m_candidates = std::move( _candidates );
+		m_color_counts = std::move( _color_counts );
+		m_palette_name = _palette.m_name;
+		m_converted = true;
+		m_selection_signature = _palette.compute_selection_signature();
+		m_colors_signature = colors_signature;
+		m_distance = _distance;
+		m_conversion_time = _conversion_time + Duration{ std::chrono::steady_clock::now() - start_time };
+	}
+
+	/**
+	* @brief Change the palette color of some distinct colors, without converting the other ones again. Used to follow the edition of a palette color.
+	* @param [in] _distinct_colors	The distinct colors to change.
+	* @param [in] _palette_indices	The new index in the palette colors vector of each of these colors.
+	* @param [in] _distances		The distance between each of these colors and its new palette color.
+	**/
+	void ConversionResult::reassign_colors( std::span< const uint32_t > _distinct_colors, std::span< const uint16_t > _palette_indices, std::span< const float > _distances )
+	{
+		if( m_image_colors == nullptr )
+			return;
+
+		const size_t nb_colors{ std::min( { _distinct_colors.size(), _palette_indices.size(), _distances.size() } ) };
+
+		for( size_t color{ 0 }; color < nb_colors; ++color )
+		{
+			const uint32_t distinct_color{ _distinct_colors[ color ] };
+			const uint16_t old_index{ m_colors_palette_indices[ distinct_color ] };
+			const int color_pixels{ m_image_colors->m_distinct_colors_pixels[ distinct_color ] };
+
+			if( old_index < m_color_counts.size() )
+				m_color_counts[ old_index ] -= color_pixels;
+
+			if( _palette_indices[ color ] < m_color_counts.size() )
+				m_color_counts[ _palette_indices[ color ] ] += color_pixels;
+
+			m_colors_palette_indices[ distinct_color ] = _palette_indices[ color ];
+			m_colors_distances[ distinct_color ] = _distances[ color ];
+		}
+	}
+
+	/**
+	* @brief Write the palette color of each pixel in an index plane.
+	* @param [out] _pixels_palette_indices The index in the palette colors vector of the new color of each pixel, Invalid_Index for transparent pixels. Must have one value per pixel of the image.
+	**/
+	void ConversionResult::fill_palette_indices( std::span< uint16_t > _pixels_palette_indices ) const
+	{
+		const size_t nb_pixels{ std::min( _pixels_palette_indices.size(), get_nb_pixels() ) };
+
+		Utils::parallel_for( nb_pixels, Utils::get_nb_tasks( nb_pixels, Min_Pixels_Per_Band ), [&]( size_t /*_task*/, size_t _first_pixel, size_t _last_pixel )
+		{
+			for( size_t pixel{ _first_pixel }; pixel < _last_pixel; ++pixel )
+				_pixels_palette_indices[ pixel ] = get_palette_index( pixel );
+		} );
+	}
+
+	const std::vector< sf::Color >& ConversionResult::get_distinct_colors() const
+	{
+		static const std::vector< sf::Color > no_colors;
+		return m_image_colors != nullptr ? m_image_colors->m_distinct_colors : no_colors;
+	}
+
+	const std::vector< int >& ConversionResult::get_distinct_colors_pixels() const
+	{
+		static const std::vector< int > no_pixels;
+		return m_image_colors != nullptr ? m_image_colors->m_distinct_colors_pixels : no_pixels;
+	}
+
+	/**
+	* @brief Get the pixels using the given distinct color, in image order.
+	* @param [in] _distinct_color The index of the color in the distinct colors.
+	**/
+	std::span< const uint32_t > ConversionResult::get_color_pixels( size_t _distinct_color ) const
+	{
+		if( m_image_colors == nullptr || _distinct_color + 1 >= m_image_colors->m_colors_first_pixel.size() )
+			return {};
+
+		const uint32_t first_pixel{ m_image_colors->m_colors_first_pixel[ _distinct_color ] };
+		return std::span{ m_image_colors->m_colors_pixels }.subspan( first_pixel, m_image_colors->m_colors_first_pixel[ _distinct_color + 1 ] - first_pixel );
+	}
+
+	/**
+	* @brief Get the index in the distinct colors of the color of each pixel, Uint32_Max for transparent pixels.
+	**/
+	std::span< const uint32_t > ConversionResult::get_pixels_distinct_colors() const
+	{
+		if( m_image_colors == nullptr )
+			return {};
+
+		return m_image_colors->m_pixels_distinct_colors;
+	}
+
+	size_t ConversionResult::get_nb_pixels() const
+	{
+		return m_image_colors != nullptr ? m_image_colors->m_pixels_distinct_colors.size() : 0;
+	}
+
+	ConversionResult::Duration ConversionResult::get_gathering_time() const
+	{
+		return m_image_colors != nullptr ? m_image_colors->m_gathering_time : Duration{};
+	}
+
+	/**
+	* @brief Get the index in the palette colors vector of the new color of the given pixel.
+	* @param [in] _pixel The index of the pixel in the image, transparent pixels included.
+	* @return The index of the palette color, Invalid_Index if the pixel is transparent or hasn't been converted.
+	**/
+	uint16_t ConversionResult::get_palette_index( size_t _pixel ) const
+	{
+		if( m_image_colors == nullptr || _pixel >= m_image_colors->m_pixels_distinct_colors.size() )
+			return Invalid_Index;
+
+		const uint32_t distinct_color{ m_image_colors->m_pixels_distinct_colors[ _pixel ] };
+
+		return distinct_color < m_colors_palette_indices.size() ? m_colors_palette_indices[ distinct_color ] : Invalid_Index;
+	}
+
+	/**
+	* @brief Forget the palette colors of the pixels, keeping the distinct colors of the image.
+	**/
+	void ConversionResult::_clear_conversion()
+	{
+		m_colors_palette_indices.clear();
+		m_colors_distances.clear();
+		m_color_counts.clear();
+		m_changed_colors.clear();
+		m_changed_colors_only = false;
+		m_palette_name.clear();
+		m_converted = false;
+		m_selection_signature = 0;
+		m_colors_signature = 0;
+		m_conversion_time = {};
+	}
+} // namespace Pixeler
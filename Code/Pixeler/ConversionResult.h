@@ -0,0 +1,176 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <SFML/Graphics/Color.hpp>
+
+#include "ColorCandidates.h"
+#include "ColorPalette.h"
+
+
+namespace Pixeler
+{
+	/************************************************************************
+	* @brief The result of the conversion of an image with a palette: the palette color of each distinct color of the image, the number of pixels using each palette color and the time it took.
+	* The palette color of a pixel is the one of its distinct color. The index plane of the displayed image is kept by the canvas.
+	* It doesn't modify the palettes or the canvas, so several results can exist at the same time and be computed on any thread.
+	* It is filled in two steps: gather_colors lists the distinct colors of the image, then PalettesManager::convert finds their closest palette colors.
+	* The distinct colors and their ranked palette candidates are shared with the results created from this one by share_colors, so converting the same image again with another selection is cheap.
+	* Such a conversion also lists the distinct colors whose palette color changed, so only their pixels have to be displayed again.
+	************************************************************************/
+	class ConversionResult
+	{
+	public:
+		using Duration = std::chrono::duration< float, std::milli >;
+
+		static constexpr uint16_t Invalid_Index{ std::numeric_limits< uint16_t >::max() };
+
+		/**
+		* @brief List the distinct colors of the given pixels and the number of pixels using each of them. Transparent pixels are ignored.
+		* Alpha doesn't take part in the conversion, so two colors only differing by their alpha are considered the same.
+		* @param [in] _pixels		The colors of all the pixels of the image, row by row.
+		* @param [in] _row_size	The width of the image. The image is split in bands of rows handled by different threads.
+		* @param [in] _nb_bands	The number of bands, 0 to choose it from the size of the image.
+		**/
+		void gather_colors( std::span< const sf::Color > _pixels, size_t _row_size, size_t _nb_bands = 0 );
+
+		/**
+		* @brief Use the distinct colors and palette candidates of another result instead of gathering them again.
+		* The conversion of the other result is copied too, so converting the colors again only measures the distances of the ones whose palette color changed.
+		* @param [in] _result The result to share the colors of.
+		**/
+		void share_colors( const ConversionResult& _result );
+
+		/**
+		* @brief Keep the palette color found for each distinct color.
+		* If the colors were already converted with the same palette colors and distance, only the colors changing of palette color are measured again and listed in the changed colors.
+		* @param [in] _palette			The palette used for the conversion. Only its name is kept, the palette is looked up by name when its colors are needed.
+		* @param [in] _distance		The distance used to compare the colors.
+		* @param [in] _candidates		The palette candidates of the distinct colors used for the conversion, kept to convert them again with another selection.
+		* @param [in] _palette_indices	The index in the palette colors vector of the closest color to each distinct color, Invalid_Index if there is none.
+		* @param [in] _color_counts	The number of pixels converted to each color of the palette.
+		* @param [in] _conversion_time	The time spent looking for the palette colors.
+		**/
+		void set_palette_indices( const ColorPalette& _palette, ColorDistance _distance, std::shared_ptr< const ColorCandidates > _candidates, std::span< const uint16_t > _palette_indices, std::vector< int >&& _color_counts, Duration _conversion_time );
+
+		/**
+		* @brief Change the palette color of some distinct colors, without converting the other ones again. Used to follow the edition of a palette color.
+		* @param [in] _distinct_colors	The distinct colors to change.
+		* @param [in] _palette_indices	The new index in the palette colors vector of each of these colors.
+		* @param [in] _distances		The distance between each of these colors and its new palette color.
+		**/
+		void reassign_colors( std::span< const uint32_t > _distinct_colors, std::span< const uint16_t > _palette_indices, std::span< const float > _distances );
+
+		/**
+		* @brief Write the palette color of each pixel in an index plane.
+		* @param [out] _pixels_palette_indices The index in the palette colors vector of the new color of each pixel, Invalid_Index for transparent pixels. Must have one value per pixel of the image.
+		**/
+		void fill_palette_indices( std::span< uint16_t > _pixels_palette_indices ) const;
+
+		const std::vector< sf::Color >&	get_distinct_colors() const;
+		const std::vector< int >&		get_distinct_colors_pixels() const;
+
+		/**
+		* @brief Get the pixels using the given distinct color, in image order.
+		* @param [in] _distinct_color The index of the color in the distinct colors.
+		**/
+		std::span< const uint32_t > get_color_pixels( size_t _distinct_color ) const;
+
+		/**
+		* @brief Get the index in the distinct colors of the color of each pixel, Uint32_Max for transparent pixels.
+		**/
+		std::span< const uint32_t > get_pixels_distinct_colors() const;
+
+		/**
+		* @brief Get the distinct colors whose palette color changed compared to the conversion shared by share_colors.
+		* @return The indices of the changed distinct colors. Only meaningful if has_changed_colors_only returns true.
+		**/
+		std::span< const uint32_t > get_changed_colors() const { return m_changed_colors; }
+
+		/**
+		* @brief Check if the conversion only differs from the one shared by share_colors by the palette color of the changed colors.
+		* It isn't the case for the first conversion of an image, or if the palette, its colors or the distance changed since the shared conversion.
+		**/
+		bool has_changed_colors_only() const { return m_changed_colors_only; }
+
+		const std::vector< uint16_t >&	get_colors_palette_indices() const { return m_colors_palette_indices; }
+		const std::vector< float >&		get_colors_distances() const { return m_colors_distances; }
+
+		/**
+		* @brief Get the palette candidates of the distinct colors, nullptr if they haven't been ranked yet.
+		**/
+		const std::shared_ptr< const ColorCandidates >& get_candidates() const { return m_candidates; }
+
+		/**
+		* @brief Get the signature of the palette colors selection used for the conversion.
+		**/
+		uint64_t get_selection_signature() const { return m_selection_signature; }
+
+		/**
+		* @brief Get the signature of the palette colors used for the conversion, whether they were selected or not.
+		**/
+		uint64_t get_colors_signature() const { return m_colors_signature; }
+
+		/**
+		* @brief Check if the distinct colors have been converted with a palette.
+		**/
+		bool is_converted() const { return m_converted; }
+
+		const std::string&	get_palette_name() const { return m_palette_name; }
+		ColorDistance		get_distance() const { return m_distance; }
+		size_t				get_nb_pixels() const;
+		Duration			get_gathering_time() const;
+		Duration			get_conversion_time() const { return m_conversion_time; }
+
+		/**
+		* @brief Get the index in the palette colors vector of the new color of the given pixel.
+		* @param [in] _pixel The index of the pixel in the image, transparent pixels included.
+		* @return The index of the palette color, Invalid_Index if the pixel is transparent or hasn't been converted.
+		**/
+		uint16_t get_palette_index( size_t _pixel ) const;
+
+		/**
+		* @brief Get the number of pixels converted to the given color.
+		* @param [in] _palette_index The index of the color in the colors vector of the palette used for the conversion.
+		* @return The number of pixels using the color, 0 if it isn't part of the palette used for the conversion.
+		**/
+		int get_color_count( uint16_t _palette_index ) const { return _palette_index < m_color_counts.size() ? m_color_counts[ _palette_index ] : 0; }
+
+	private:
+		/**
+		* @brief Forget the palette colors of the pixels, keeping the distinct colors of the image.
+		**/
+		void _clear_conversion();
+
+		/************************************************************************
+		* @brief The distinct colors of an image, shared by all the conversions of this image.
+		************************************************************************/
+		struct ImageColors
+		{
+			std::vector< sf::Color >	m_distinct_colors;						// The distinct colors of the image, in the order of their first pixel.
+			std::vector< int >			m_distinct_colors_pixels;				// The number of pixels using each distinct color.
+			std::vector< uint32_t >		m_pixels_distinct_colors;				// The index in m_distinct_colors of the color of each pixel, Uint32_Max for transparent pixels.
+			std::vector< uint32_t >		m_colors_first_pixel;					// The position in m_colors_pixels of the first pixel of each distinct color, followed by the number of opaque pixels.
+			std::vector< uint32_t >		m_colors_pixels;						// The opaque pixels grouped by distinct color, so the pixels of a color can be found without going through the whole image.
+			Duration					m_gathering_time{};						// The time spent listing the distinct colors of the image.
+		};
+
+		std::shared_ptr< const ImageColors >		m_image_colors;							// The distinct colors of the converted image.
+		std::shared_ptr< const ColorCandidates >	m_candidates;							// The palette candidates of the distinct colors, for the palette and distance of the conversion.
+		std::vector< uint16_t >						m_colors_palette_indices;				// The index in the palette colors vector of the new color of each distinct color.
+		std::vector< float >						m_colors_distances;						// The distance between each distinct color and its palette color, Flt_Max if it has none.
+		std::vector< int >							m_color_counts;							// The number of pixels converted to each color of the palette.
+		std::vector< uint32_t >						m_changed_colors;						// The distinct colors whose palette color changed compared to the shared conversion.
+		bool										m_changed_colors_only{ false };			// Only the changed colors differ from the shared conversion, the pixels of the other ones keep their palette color.
+		std::string									m_palette_name;							// The name of the palette used for the conversion. Its address isn't kept, it changes when palettes are added or removed.
+		bool										m_converted{ false };					// The distinct colors have been converted with the palette.
+		uint64_t									m_selection_signature{ 0 };				// The signature of the palette colors selection used for the conversion.
+		uint64_t									m_colors_signature{ 0 };				// The signature of the palette colors used for the conversion, whether they were selected or not.
+		ColorDistance								m_distance{ ColorDistance::RGB };		// The distance used for the conversion.
+		Duration									m_conversion_time{};					// The time spent finding the palette colors.
+	};
+} // namespace Pixeler
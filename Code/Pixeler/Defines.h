@@ -12,8 +12,10 @@ namespace Pixeler
 	static constexpr const char*	Action_ShowSecondaryHighlight	{ "Show Secondary Highlight" };
 
 	static constexpr const char*	Tooltip_ShowGrid				{ "Display a grid over the sprite to visually separate pixels" };
+	static constexpr const char*	Tooltip_ShowMinimap				{ "Display an overview of the image at the bottom right corner of the canvas, click it to move there" };
 	static constexpr const char*	Tooltip_ShowOriginal			{ "Display the original sprite on top of the palette converted one" };
 	static constexpr const char*	Tooltip_OriginalOpacity			{ "Change the opacity of the original sprite" };
+	static constexpr const char*	Tooltip_SkippedFrames			{ "Frames displaying the previously drawn canvas because nothing on it changed, the canvas costs almost nothing while idle" };
 
 	enum ColorChannel
 	{
@@ -37,6 +39,7 @@ namespace Pixeler
 
 	inline constexpr float		Flt_Max{ std::numeric_limits<float>::max() };
 	inline constexpr uint32_t	Uint32_Max{ std::numeric_limits<uint32_t>::max() };
+	inline constexpr uint8_t	Min_Pixel_Alpha{ 50 };		// Pixels with a lower alpha are considered transparent, they are neither displayed nor converted.
 
 	struct PixelPosition
 	{
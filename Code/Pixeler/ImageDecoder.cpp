@@ -0,0 +1,688 @@
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <string>
+
+#include "Defines.h"
+#include "ImageDecoder.h"
+#include "Inflater.h"
+
+
+namespace Pixeler
+{
+	static constexpr uint8_t Png_Signature[ 8 ]{ 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+
+	enum PngColorType : uint8_t
+	{
+		gray			= 0,
+		rgb				= 2,
+		palette			= 3,
+		gray_alpha		= 4,
+		rgb_alpha		= 6,
+	};
+
+	/**
+	* @brief Read an unsigned integer stored with its most significant byte first, as in PNG files.
+	**/
+	static bool read_big_endian( std::istream& _stream, uint32_t& _value, uint32_t _nb_bytes = 4 )
+	{
+		uint8_t bytes[ 4 ]{};
+
+		if( _stream.read( reinterpret_cast< char* >( bytes ), _nb_bytes ).gcount() != static_cast< std::streamsize >( _nb_bytes ) )
+			return false;
+
+		_value = 0;
+		for( uint32_t byte{ 0 }; byte < _nb_bytes; ++byte )
+			_value = ( _value << 8 ) | bytes[ byte ];
+
+		return true;
+	}
+
+	/**
+	* @brief Read an unsigned integer stored with its least significant byte first, as in BMP and TGA files.
+	**/
+	static bool read_little_endian( std::istream& _stream, uint32_t& _value, uint32_t _nb_bytes = 4 )
+	{
+		uint8_t bytes[ 4 ]{};
+
+		if( _stream.read( reinterpret_cast< char* >( bytes ), _nb_bytes ).gcount() != static_cast< std::streamsize >( _nb_bytes ) )
+			return false;
+
+		_value = 0;
+		for( uint32_t byte{ _nb_bytes }; byte > 0; --byte )
+			_value = ( _value << 8 ) | bytes[ byte - 1 ];
+
+		return true;
+	}
+
+	/**
+	* @brief Predict a byte of a PNG row from its left, top and top left neighbors, keeping the one closest to left + top - top left.
+	**/
+	static uint8_t paeth_predictor( int _left, int _top, int _top_left )
+	{
+		const int estimate{ _left + _top - _top_left };
+		const int left_distance{ std::abs( estimate - _left ) };
+		const int top_distance{ std::abs( estimate - _top ) };
+		const int top_left_distance{ std::abs( estimate - _top_left ) };
+
+		if( left_distance <= top_distance && left_distance <= top_left_distance )
+			return static_cast< uint8_t >( _left );
+
+		return static_cast< uint8_t >( top_distance <= top_left_distance ? _top : _top_left );
+	}
+
+	/**
+	* @brief Scale a channel value stored with the given number of bits to 8 bits.
+	**/
+	static uint8_t to_8_bits( uint32_t _value, uint32_t _nb_bits )
+	{
+		if( _nb_bits == 8 )
+			return static_cast< uint8_t >( _value );
+
+		if( _nb_bits > 8 )
+			return static_cast< uint8_t >( _value >> ( _nb_bits - 8 ) );
+
+		return static_cast< uint8_t >( _value * 255 / ( ( 1u << _nb_bits ) - 1 ) );
+	}
+
+	ImageDecoder::ImageDecoder() = default;
+	ImageDecoder::~ImageDecoder() = default;
+
+	/**
+	* @brief Open a file and read its header.
+	* @param [in] _path The path of the image.
+	* @return opened if the rows can be read, unsupported or too_large otherwise.
+	**/
+	ImageDecoder::OpenResult ImageDecoder::open( std::string_view _path )
+	{
+		close();
+
+		m_file.open( std::string{ _path }, std::ios::binary );
+
+		if( m_file.is_open() == false )
+			return OpenResult::unsupported;
+
+		uint8_t signature[ std::size( Png_Signature ) ]{};
+		m_file.read( reinterpret_cast< char* >( signature ), std::size( signature ) );
+		m_file.clear();
+		m_file.seekg( 0 );
+
+		bool opened{ false };
+
+		// TGA files have no signature, so they are only tried from the extension of the file.
+		if( std::ranges::equal( signature, Png_Signature ) )
+			opened = _open_png();
+		else if( signature[ 0 ] == 'B' && signature[ 1 ] == 'M' )
+			opened = _open_bmp();
+		else if( _path.ends_with( ".tga" ) || _path.ends_with( ".TGA" ) )
+			opened = _open_tga();
+
+		if( opened == false || m_size.x == 0 || m_size.y == 0 )
+		{
+			close();
+			return OpenResult::unsupported;
+		}
+
+		if( is_size_supported( m_size ) == false )
+		{
+			close();
+			return OpenResult::too_large;
+		}
+
+		return OpenResult::opened;
+	}
+
+	/**
+	* @brief Check if an image can be displayed on the canvas, whose pixel indices are 32 bits.
+	* @param [in] _size The size of the image.
+	* @return True if the image has less than Uint32_Max pixels.
+	**/
+	bool ImageDecoder::is_size_supported( const sf::Vector2u& _size )
+	{
+		return static_cast< uint64_t >( _size.x ) * _size.y < Uint32_Max;
+	}
+
+	/**
+	* @brief Close the file and free the decoding buffers.
+	**/
+	void ImageDecoder::close()
+	{
+		m_file.close();
+		m_file.clear();
+		m_format = Format::none;
+		m_size = { 0, 0 };
+		m_nb_read_rows = 0;
+		m_bottom_up = false;
+		m_row_bytes = {};
+		m_previous_row_bytes = {};
+
+		m_inflater.reset();
+		m_png_idat_remaining = 0;
+		m_png_data_ended = false;
+		m_png_has_transparent_color = false;
+
+		m_tga_packet_remaining = 0;
+	}
+
+	/**
+	* @brief Decode the next row of the image. Rows are given in the order of the file, which is bottom to top for most BMP and TGA files.
+	* @param [out] _row The colors of the pixels of the row, as many as the width of the image.
+	* @return The index of the decoded row in the image, counted from the top. Uint32_Max if the file is corrupted or all the rows have been read.
+	**/
+	uint32_t ImageDecoder::read_row( std::span< sf::Color > _row )
+	{
+		if( m_format == Format::none || m_nb_read_rows >= m_size.y || _row.size() < m_size.x )
+			return Uint32_Max;
+
+		bool row_read{ false };
+
+		switch( m_format )
+		{
+			case Format::png: row_read = _read_png_row( _row ); break;
+			case Format::bmp: row_read = _read_bmp_row( _row ); break;
+			case Format::tga: row_read = _read_tga_row( _row ); break;
+			default: break;
+		}
+
+		if( row_read == false )
+			return Uint32_Max;
+
+		const uint32_t row{ m_bottom_up ? m_size.y - 1 - m_nb_read_rows : m_nb_read_rows };
+		++m_nb_read_rows;
+
+		return row;
+	}
+
+	bool ImageDecoder::_open_png()
+	{
+		m_file.seekg( std::size( Png_Signature ) );
+
+		uint32_t bit_depth{ 0 };
+		uint32_t color_type{ 0 };
+		uint32_t interlace_method{ 0 };
+
+		for( uint32_t color{ 0 }; color < m_png_palette.size(); ++color )
+			m_png_palette[ color ] = sf::Color::Black;
+
+		// The chunks before the image data give its size and format, the palette and the transparency.
+		while( true )
+		{
+			uint32_t chunk_length{ 0 };
+			char chunk_type[ 4 ]{};
+
+			if( read_big_endian( m_file, chunk_length ) == false || m_file.read( chunk_type, 4 ).gcount() != 4 )
+				return false;
+
+			const std::string_view type{ chunk_type, 4 };
+
+			if( type == "IDAT" )
+			{
+				m_png_idat_remaining = chunk_length;
+				break;
+			}
+
+			if( type == "IHDR" )
+			{
+				uint32_t unused{ 0 };
+
+				if( read_big_endian( m_file, m_size.x ) == false || read_big_endian( m_file, m_size.y ) == false
+					|| read_big_endian( m_file, bit_depth, 1 ) == false || read_big_endian( m_file, color_type, 1 ) == false
+					|| read_big_endian( m_file, unused, 2 ) == false || read_big_endian( m_file, interlace_method, 1 ) == false )
+					return false;
+
+				m_file.seekg( chunk_length - 13, std::ios::cur );
+			}
+			else if( type == "PLTE" )
+			{
+				for( uint32_t color{ 0 }; color < std::min( chunk_length / 3, 256u ); ++color )
+				{
+					uint32_t rgb{ 0 };
+
+					if( read_big_endian( m_file, rgb, 3 ) == false )
+						return false;
+
+					m_png_palette[ color ] = sf::Color{ static_cast< sf::Uint8 >( rgb >> 16 ), static_cast< sf::Uint8 >( rgb >> 8 ), static_cast< sf::Uint8 >( rgb ) };
+				}
+
+				m_file.seekg( chunk_length - std::min( chunk_length / 3, 256u ) * 3, std::ios::cur );
+			}
+			else if( type == "tRNS" )
+			{
+				// The alpha of each palette color, or the gray or RGB value of the transparent pixels.
+				if( color_type == PngColorType::palette )
+				{
+					for( uint32_t color{ 0 }; color < std::min( chunk_length, 256u ); ++color )
+					{
+						uint32_t alpha{ 0 };
+
+						if( read_big_endian( m_file, alpha, 1 ) == false )
+							return false;
+
+						m_png_palette[ color ].a = static_cast< sf::Uint8 >( alpha );
+					}
+
+					m_file.seekg( chunk_length - std::min( chunk_length, 256u ), std::ios::cur );
+				}
+				else
+				{
+					const uint32_t nb_values{ std::min( chunk_length / 2, 3u ) };
+
+					for( uint32_t value{ 0 }; value < nb_values; ++value )
+					{
+						uint32_t channel{ 0 };
+
+						if( read_big_endian( m_file, channel, 2 ) == false )
+							return false;
+
+						m_png_transparent_color[ value ] = static_cast< uint16_t >( channel );
+					}
+
+					m_png_has_transparent_color = nb_values > 0;
+					m_file.seekg( chunk_length - nb_values * 2, std::ios::cur );
+				}
+			}
+			else
+				m_file.seekg( chunk_length, std::ios::cur );
+
+			// CRC
+			m_file.seekg( 4, std::ios::cur );
+
+			if( m_file.fail() )
+				return false;
+		}
+
+		uint32_t nb_channels{ 0 };
+
+		switch( color_type )
+		{
+			case PngColorType::gray:		nb_channels = 1; break;
+			case PngColorType::rgb:			nb_channels = 3; break;
+			case PngColorType::palette:		nb_channels = 1; break;
+			case PngColorType::gray_alpha:	nb_channels = 2; break;
+			case PngColorType::rgb_alpha:	nb_channels = 4; break;
+			default: return false;
+		}
+
+		const bool valid_bit_depth{ ( bit_depth == 8 || bit_depth == 16 || ( bit_depth < 8 && std::has_single_bit( bit_depth ) && ( color_type == PngColorType::gray || color_type == PngColorType::palette ) ) )
+			&& ( bit_depth != 16 || color_type != PngColorType::palette ) };
+
+		// Interlaced images don't store their rows in order, they are left to sf::Image.
+		if( valid_bit_depth == false || interlace_method != 0 )
+			return false;
+
+		m_png_color_type = static_cast< uint8_t >( color_type );
+		m_png_bit_depth = static_cast< uint8_t >( bit_depth );
+
+		// Each row starts with the type of filter used to predict its bytes.
+		const size_t row_size{ 1 + ( static_cast< size_t >( m_size.x ) * nb_channels * bit_depth + 7 ) / 8 };
+
+		m_row_bytes.assign( row_size, 0 );
+		m_previous_row_bytes.assign( row_size, 0 );
+		m_inflater = std::make_unique< Inflater >( [this]( uint8_t* _buffer, size_t _size ) { return _read_png_data( _buffer, _size ); } );
+		m_format = Format::png;
+
+		return true;
+	}
+
+	bool ImageDecoder::_open_bmp()
+	{
+		uint32_t pixels_offset{ 0 };
+		uint32_t header_size{ 0 };
+		uint32_t width{ 0 };
+		uint32_t height{ 0 };
+		uint32_t planes_and_bits{ 0 };
+		uint32_t compression{ 0 };
+
+		m_file.seekg( 10 );
+
+		if( read_little_endian( m_file, pixels_offset ) == false || read_little_endian( m_file, header_size ) == false
+			|| read_little_endian( m_file, width ) == false || read_little_endian( m_file, height ) == false
+			|| read_little_endian( m_file, planes_and_bits ) == false || read_little_endian( m_file, compression ) == false )
+			return false;
+
+		// Older headers, compressed and paletted images are left to sf::Image.
+		m_bmp_bits_per_pixel = planes_and_bits >> 16;
+
+		if( header_size < 40 || static_cast< int32_t >( width ) <= 0 || static_cast< int32_t >( height ) == 0 )
+			return false;
+
+		// Uncompressed 32 bits pixels keep their alpha in their highest byte.
+		if( m_bmp_bits_per_pixel == 24 && compression == 0 )
+			m_bmp_masks = { 0x00FF0000, 0x0000FF00, 0x000000FF, 0 };
+		else if( m_bmp_bits_per_pixel == 32 && compression == 0 )
+			m_bmp_masks = { 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000 };
+		else if( m_bmp_bits_per_pixel == 32 && compression == 3 )
+		{
+			// The masks follow the 40 bytes header, the alpha one is only part of the bigger headers.
+			m_file.seekg( 14 + 40 );
+
+			for( uint32_t mask{ 0 }; mask < ( header_size >= 56 ? 4u : 3u ); ++mask )
+			{
+				if( read_little_endian( m_file, m_bmp_masks[ mask ] ) == false )
+					return false;
+			}
+
+			if( m_bmp_masks[ 0 ] == 0 || m_bmp_masks[ 1 ] == 0 || m_bmp_masks[ 2 ] == 0 )
+				return false;
+		}
+		else
+			return false;
+
+		// A positive height means the rows are stored from the bottom to the top.
+		m_bottom_up = static_cast< int32_t >( height ) > 0;
+		m_size = { width, static_cast< uint32_t >( std::abs( static_cast< int32_t >( height ) ) ) };
+
+		// Rows are padded to 4 bytes.
+		m_row_bytes.assign( ( static_cast< size_t >( m_size.x ) * m_bmp_bits_per_pixel + 31 ) / 32 * 4, 0 );
+		m_file.seekg( pixels_offset );
+		m_format = Format::bmp;
+
+		// Many files leave the alpha of their pixels to 0 without meaning them to be transparent. As SFML does, they are considered opaque.
+		if( m_bmp_masks[ 3 ] != 0 && _has_bmp_alpha() == false )
+			m_bmp_masks[ 3 ] = 0;
+
+		return m_file.good();
+	}
+
+	bool ImageDecoder::_open_tga()
+	{
+		uint8_t header[ 18 ]{};
+
+		if( m_file.read( reinterpret_cast< char* >( header ), std::size( header ) ).gcount() != static_cast< std::streamsize >( std::size( header ) ) )
+			return false;
+
+		const uint32_t id_length{ header[ 0 ] };
+		const uint32_t color_map_type{ header[ 1 ] };
+		const uint32_t image_type{ header[ 2 ] };
+		const uint32_t color_map_length{ header[ 5 ] | static_cast< uint32_t >( header[ 6 ] ) << 8 };
+		const uint32_t color_map_entry_size{ header[ 7 ] };
+		const uint32_t bits_per_pixel{ header[ 16 ] };
+		const uint32_t descriptor{ header[ 17 ] };
+
+		m_size = { header[ 12 ] | static_cast< uint32_t >( header[ 13 ] ) << 8, header[ 14 ] | static_cast< uint32_t >( header[ 15 ] ) << 8 };
+
+		// Truecolor or grayscale images, uncompressed (2, 3) or RLE (10, 11). Paletted and right to left images are left to sf::Image.
+		const bool truecolor{ ( image_type == 2 || image_type == 10 ) && ( bits_per_pixel == 24 || bits_per_pixel == 32 ) };
+		const bool grayscale{ ( image_type == 3 || image_type == 11 ) && bits_per_pixel == 8 };
+
+		if( ( truecolor == false && grayscale == false ) || color_map_type > 1 || ( descriptor & 0x10 ) != 0 )
+			return false;
+
+		m_tga_bytes_per_pixel = bits_per_pixel / 8;
+		m_tga_rle = image_type >= 10;
+		m_tga_packet_remaining = 0;
+		m_bottom_up = ( descriptor & 0x20 ) == 0;
+		m_row_bytes.assign( static_cast< size_t >( m_size.x ) * m_tga_bytes_per_pixel, 0 );
+
+		// An unused color map can still be present.
+		m_file.seekg( id_length + ( color_map_type == 1 ? color_map_length * ( ( color_map_entry_size + 7 ) / 8 ) : 0 ), std::ios::cur );
+		m_format = Format::tga;
+
+		return m_file.good();
+	}
+
+	bool ImageDecoder::_read_png_row( std::span< sf::Color > _row )
+	{
+		if( m_inflater->read( m_row_bytes.data(), m_row_bytes.size() ) == false )
+			return false;
+
+		const uint32_t nb_channels{ m_png_color_type == PngColorType::rgb ? 3u : m_png_color_type == PngColorType::gray_alpha ? 2u : m_png_color_type == PngColorType::rgb_alpha ? 4u : 1u };
+		const size_t pixel_size{ std::max< size_t >( nb_channels * m_png_bit_depth / 8, 1 ) };		// The distance to the byte predicting the current one.
+		const uint8_t filter{ m_row_bytes[ 0 ] };
+		uint8_t* row{ m_row_bytes.data() + 1 };
+		const uint8_t* previous_row{ m_previous_row_bytes.data() + 1 };
+		const size_t row_size{ m_row_bytes.size() - 1 };
+
+		switch( filter )
+		{
+			case 0:
+				break;
+			case 1:
+				for( size_t byte{ pixel_size }; byte < row_size; ++byte )
+					row[ byte ] += row[ byte - pixel_size ];
+				break;
+			case 2:
+				for( size_t byte{ 0 }; byte < row_size; ++byte )
+					row[ byte ] += previous_row[ byte ];
+				break;
+			case 3:
+				for( size_t byte{ 0 }; byte < row_size; ++byte )
+					row[ byte ] += static_cast< uint8_t >( ( ( byte >= pixel_size ? row[ byte - pixel_size ] : 0 ) + previous_row[ byte ] ) / 2 );
+				break;
+			case 4:
+				for( size_t byte{ 0 }; byte < row_size; ++byte )
+					row[ byte ] += byte >= pixel_size ? paeth_predictor( row[ byte - pixel_size ], previous_row[ byte ], previous_row[ byte - pixel_size ] ) : previous_row[ byte ];
+				break;
+			default:
+				return false;
+		}
+
+		// Most images are stored with 8 bits RGBA pixels, which don't need any conversion.
+		if( m_png_color_type == PngColorType::rgb_alpha && m_png_bit_depth == 8 )
+		{
+			for( size_t pixel{ 0 }; pixel < m_size.x; ++pixel )
+				_row[ pixel ] = { row[ pixel * 4 ], row[ pixel * 4 + 1 ], row[ pixel * 4 + 2 ], row[ pixel * 4 + 3 ] };
+
+			std::swap( m_row_bytes, m_previous_row_bytes );
+			return true;
+		}
+
+		auto get_sample = [&]( size_t _pixel, uint32_t _channel ) -> uint32_t
+		{
+			const size_t sample{ _pixel * nb_channels + _channel };
+
+			if( m_png_bit_depth == 16 )
+				return static_cast< uint32_t >( row[ sample * 2 ] ) << 8 | row[ sample * 2 + 1 ];
+
+			if( m_png_bit_depth == 8 )
+				return row[ sample ];
+
+			// Samples smaller than a byte start from its most significant bits.
+			const size_t first_bit{ sample * m_png_bit_depth };
+			return ( row[ first_bit / 8 ] >> ( 8 - m_png_bit_depth - first_bit % 8 ) ) & ( ( 1u << m_png_bit_depth ) - 1 );
+		};
+
+		for( size_t pixel{ 0 }; pixel < m_size.x; ++pixel )
+		{
+			sf::Color& color{ _row[ pixel ] };
+
+			switch( m_png_color_type )
+			{
+				case PngColorType::gray:
+				{
+					const uint32_t gray{ get_sample( pixel, 0 ) };
+					const uint8_t gray_8_bits{ to_8_bits( gray, m_png_bit_depth ) };
+					color = { gray_8_bits, gray_8_bits, gray_8_bits, m_png_has_transparent_color && gray == m_png_transparent_color[ 0 ] ? sf::Uint8{ 0 } : sf::Uint8{ 255 } };
+					break;
+				}
+				case PngColorType::rgb:
+				{
+					const uint32_t red{ get_sample( pixel, 0 ) };
+					const uint32_t green{ get_sample( pixel, 1 ) };
+					const uint32_t blue{ get_sample( pixel, 2 ) };
+					const bool transparent{ m_png_has_transparent_color && red == m_png_transparent_color[ 0 ] && green == m_png_transparent_color[ 1 ] && blue == m_png_transparent_color[ 2 ] };
+					color = { to_8_bits( red, m_png_bit_depth ), to_8_bits( green, m_png_bit_depth ), to_8_bits( blue, m_png_bit_depth ), transparent ? sf::Uint8{ 0 } : sf::Uint8{ 255 } };
+					break;
+				}
+				case PngColorType::palette:
+					color = m_png_palette[ get_sample( pixel, 0 ) ];
+					break;
+				case PngColorType::gray_alpha:
+				{
+					const uint8_t gray{ to_8_bits( get_sample( pixel, 0 ), m_png_bit_depth ) };
+					color = { gray, gray, gray, to_8_bits( get_sample( pixel, 1 ), m_png_bit_depth ) };
+					break;
+				}
+				default:
+					color = { to_8_bits( get_sample( pixel, 0 ), m_png_bit_depth ), to_8_bits( get_sample( pixel, 1 ), m_png_bit_depth ), to_8_bits( get_sample( pixel, 2 ), m_png_bit_depth ), to_8_bits( get_sample( pixel, 3 ), m_png_bit_depth ) };
+					break;
+			}
+		}
+
+		std::swap( m_row_bytes, m_previous_row_bytes );
+		return true;
+	}
+
+	/**
+	* @brief Check if a 32 bits BMP file uses its alpha channel, reading its pixels until one has a non zero alpha. The file is left at the same position.
+	* @return False if the alpha of all the pixels is 0, in which case they are meant to be opaque.
+	**/
+	bool ImageDecoder::_has_bmp_alpha()
+	{
+		const std::streampos pixels_position{ m_file.tellg() };
+		bool has_alpha{ false };
+
+		for( uint32_t row{ 0 }; row < m_size.y && has_alpha == false; ++row )
+		{
+			if( m_file.read( reinterpret_cast< char* >( m_row_bytes.data() ), m_row_bytes.size() ).gcount() != static_cast< std::streamsize >( m_row_bytes.size() ) )
+				break;
+
+			for( size_t pixel{ 0 }; pixel < m_size.x && has_alpha == false; ++pixel )
+			{
+				const uint8_t* bytes{ m_row_bytes.data() + pixel * 4 };
+				has_alpha = ( ( bytes[ 0 ] | static_cast< uint32_t >( bytes[ 1 ] ) << 8 | static_cast< uint32_t >( bytes[ 2 ] ) << 16 | static_cast< uint32_t >( bytes[ 3 ] ) << 24 ) & m_bmp_masks[ 3 ] ) != 0;
+			}
+		}
+
+		// A truncated file stops the search, its rows are decoded as far as they go.
+		m_file.clear();
+		m_file.seekg( pixels_position );
+
+		return has_alpha;
+	}
+
+	bool ImageDecoder::_read_bmp_row( std::span< sf::Color > _row )
+	{
+		if( m_file.read( reinterpret_cast< char* >( m_row_bytes.data() ), m_row_bytes.size() ).gcount() != static_cast< std::streamsize >( m_row_bytes.size() ) )
+			return false;
+
+		if( m_bmp_bits_per_pixel == 24 )
+		{
+			for( size_t pixel{ 0 }; pixel < m_size.x; ++pixel )
+			{
+				const uint8_t* bgr{ m_row_bytes.data() + pixel * 3 };
+				_row[ pixel ] = { bgr[ 2 ], bgr[ 1 ], bgr[ 0 ], 255 };
+			}
+
+			return true;
+		}
+
+		auto get_channel = [&]( uint32_t _value, uint32_t _mask ) -> uint8_t
+		{
+			return to_8_bits( ( _value & _mask ) >> std::countr_zero( _mask ), static_cast< uint32_t >( std::popcount( _mask ) ) );
+		};
+
+		for( size_t pixel{ 0 }; pixel < m_size.x; ++pixel )
+		{
+			const uint8_t* bytes{ m_row_bytes.data() + pixel * 4 };
+			const uint32_t value{ bytes[ 0 ] | static_cast< uint32_t >( bytes[ 1 ] ) << 8 | static_cast< uint32_t >( bytes[ 2 ] ) << 16 | static_cast< uint32_t >( bytes[ 3 ] ) << 24 };
+
+			_row[ pixel ] = { get_channel( value, m_bmp_masks[ 0 ] ), get_channel( value, m_bmp_masks[ 1 ] ), get_channel( value, m_bmp_masks[ 2 ] ), m_bmp_masks[ 3 ] != 0 ? get_channel( value, m_bmp_masks[ 3 ] ) : sf::Uint8{ 255 } };
+		}
+
+		return true;
+	}
+
+	bool ImageDecoder::_read_tga_row( std::span< sf::Color > _row )
+	{
+		if( m_tga_rle == false )
+		{
+			if( m_file.read( reinterpret_cast< char* >( m_row_bytes.data() ), m_row_bytes.size() ).gcount() != static_cast< std::streamsize >( m_row_bytes.size() ) )
+				return false;
+
+			for( size_t pixel{ 0 }; pixel < m_size.x; ++pixel )
+			{
+				const uint8_t* bytes{ m_row_bytes.data() + pixel * m_tga_bytes_per_pixel };
+
+				if( m_tga_bytes_per_pixel == 1 )
+					_row[ pixel ] = { bytes[ 0 ], bytes[ 0 ], bytes[ 0 ], 255 };
+				else
+					_row[ pixel ] = { bytes[ 2 ], bytes[ 1 ], bytes[ 0 ], m_tga_bytes_per_pixel == 4 ? bytes[ 3 ] : sf::Uint8{ 255 } };
+			}
+
+			return true;
+		}
+
+		// A packet either repeats one pixel or lists raw ones, and can continue on the next row.
+		for( size_t pixel{ 0 }; pixel < m_size.x; ++pixel )
+		{
+			if( m_tga_packet_remaining == 0 )
+			{
+				const int packet_header{ m_file.get() };
+
+				if( packet_header == std::char_traits< char >::eof() )
+					return false;
+
+				m_tga_packet_repeated = ( packet_header & 0x80 ) != 0;
+				m_tga_packet_remaining = ( packet_header & 0x7F ) + 1;
+
+				if( m_tga_packet_repeated )
+					m_tga_packet_color = _read_tga_pixel();
+			}
+
+			_row[ pixel ] = m_tga_packet_repeated ? m_tga_packet_color : _read_tga_pixel();
+			--m_tga_packet_remaining;
+		}
+
+		return m_file.good();
+	}
+
+	/**
+	* @brief Read the compressed image data of the PNG file, which can be split in several IDAT chunks.
+	* @param [out] _buffer	The buffer to fill.
+	* @param [in] _size		The size of the buffer.
+	* @return The number of bytes read, 0 once the last IDAT chunk has been read.
+	**/
+	size_t ImageDecoder::_read_png_data( uint8_t* _buffer, size_t _size )
+	{
+		size_t nb_read_bytes{ 0 };
+
+		while( nb_read_bytes < _size && m_png_data_ended == false )
+		{
+			if( m_png_idat_remaining == 0 )
+			{
+				uint32_t chunk_length{ 0 };
+				char chunk_type[ 4 ]{};
+
+				// Skip the CRC of the current chunk.
+				m_file.seekg( 4, std::ios::cur );
+
+				if( read_big_endian( m_file, chunk_length ) == false || m_file.read( chunk_type, 4 ).gcount() != 4 || std::string_view{ chunk_type, 4 } != "IDAT" )
+				{
+					m_png_data_ended = true;
+					break;
+				}
+
+				m_png_idat_remaining = chunk_length;
+				continue;
+			}
+
+			const size_t nb_bytes{ std::min< size_t >( _size - nb_read_bytes, m_png_idat_remaining ) };
+
+			if( m_file.read( reinterpret_cast< char* >( _buffer + nb_read_bytes ), nb_bytes ).gcount() != static_cast< std::streamsize >( nb_bytes ) )
+			{
+				m_png_data_ended = true;
+				break;
+			}
+
+			nb_read_bytes += nb_bytes;
+			m_png_idat_remaining -= static_cast< uint32_t >( nb_bytes );
+		}
+
+		return nb_read_bytes;
+	}
+
+	/**
+	* @brief Read the next pixel of a TGA file, stored on m_tga_bytes_per_pixel bytes.
+	**/
+	sf::Color ImageDecoder::_read_tga_pixel()
+	{
+		uint8_t bytes[ 4 ]{};
+		m_file.read( reinterpret_cast< char* >( bytes ), m_tga_bytes_per_pixel );
+
+		if( m_tga_bytes_per_pixel == 1 )
+			return { bytes[ 0 ], bytes[ 0 ], bytes[ 0 ], 255 };
+
+		return { bytes[ 2 ], bytes[ 1 ], bytes[ 0 ], m_tga_bytes_per_pixel == 4 ? bytes[ 3 ] : sf::Uint8{ 255 } };
+	}
+} // namespace Pixeler
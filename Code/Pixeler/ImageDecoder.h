@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/System/Vector2.hpp>
+
+
+namespace Pixeler
+{
+	class Inflater;
+
+	/************************************************************************
+	* @brief Decode an image file row by row on the CPU, so neither the file nor the decoded image have to be held in memory, and no texture is created.
+	* Supports PNG files without interlacing, uncompressed 24 and 32 bits BMP files and uncompressed or RLE TGA files.
+	* Other files are left to sf::Image, which decodes the whole image at once.
+	************************************************************************/
+	class ImageDecoder
+	{
+	public:
+		/************************************************************************
+		* @brief The outcome of opening a file.
+		************************************************************************/
+		enum class OpenResult
+		{
+			opened,
+			unsupported,		// The file can't be read or isn't in a supported format, it can still be decoded by sf::Image.
+			too_large,			// The image has too many pixels for the canvas, it mustn't be decoded at all.
+		};
+
+		ImageDecoder();
+		~ImageDecoder();
+
+		/**
+		* @brief Open a file and read its header.
+		* @param [in] _path The path of the image.
+		* @return opened if the rows can be read, unsupported or too_large otherwise.
+		**/
+		OpenResult open( std::string_view _path );
+
+		/**
+		* @brief Check if an image can be displayed on the canvas, whose pixel indices are 32 bits.
+		* @param [in] _size The size of the image.
+		* @return True if the image has less than Uint32_Max pixels.
+		**/
+		static bool is_size_supported( const sf::Vector2u& _size );
+
+		/**
+		* @brief Close the file and free the decoding buffers.
+		**/
+		void close();
+
+		/**
+		* @brief Decode the next row of the image. Rows are given in the order of the file, which is bottom to top for most BMP and TGA files.
+		* @param [out] _row The colors of the pixels of the row, as many as the width of the image.
+		* @return The index of the decoded row in the image, counted from the top. Uint32_Max if the file is corrupted or all the rows have been read.
+		**/
+		uint32_t read_row( std::span< sf::Color > _row );
+
+		const sf::Vector2u& get_size() const { return m_size; }
+
+	private:
+		enum class Format
+		{
+			none,
+			png,
+			bmp,
+			tga,
+		};
+
+		bool _open_png();
+		bool _open_bmp();
+		bool _open_tga();
+
+		bool _read_png_row( std::span< sf::Color > _row );
+		bool _read_bmp_row( std::span< sf::Color > _row );
+		bool _read_tga_row( std::span< sf::Color > _row );
+
+		/**
+		* @brief Check if a 32 bits BMP file uses its alpha channel, reading its pixels until one has a non zero alpha. The file is left at the same position.
+		* @return False if the alpha of all the pixels is 0, in which case they are meant to be opaque.
+		**/
+		bool _has_bmp_alpha();
+
+		/**
+		* @brief Read the compressed image data of the PNG file, which can be split in several IDAT chunks.
+		* @param [out] _buffer	The buffer to fill.
+		* @param [in] _size		The size of the buffer.
+		* @return The number of bytes read, 0 once the last IDAT chunk has been read.
+		**/
+		size_t _read_png_data( uint8_t* _buffer, size_t _size );
+
+		/**
+		* @brief Read the next pixel of a TGA file, stored on m_tga_bytes_per_pixel bytes.
+		**/
+		sf::Color _read_tga_pixel();
+
+		std::ifstream				m_file;
+		Format						m_format{ Format::none };
+		sf::Vector2u				m_size{ 0, 0 };
+		uint32_t					m_nb_read_rows{ 0 };
+		bool						m_bottom_up{ false };					// The first row of the file is the bottom one of the image.
+		std::vector< uint8_t >		m_row_bytes;							// The bytes of the row being decoded.
+		std::vector< uint8_t >		m_previous_row_bytes;					// The bytes of the previous row, PNG filters predict a row from it.
+
+		// PNG
+		std::unique_ptr< Inflater >	m_inflater;
+		uint8_t						m_png_color_type{ 0 };
+		uint8_t						m_png_bit_depth{ 0 };
+		uint32_t					m_png_idat_remaining{ 0 };				// The number of bytes left in the current IDAT chunk.
+		bool						m_png_data_ended{ false };				// The chunk following the last IDAT one has been reached.
+		std::array< sf::Color, 256 > m_png_palette{};						// The colors of a paletted image, with the transparency of its tRNS chunk.
+		std::array< uint16_t, 3 >	m_png_transparent_color{};				// The gray or RGB value of the transparent pixels of an image without alpha channel.
+		bool						m_png_has_transparent_color{ false };
+
+		// BMP
+		uint32_t					m_bmp_bits_per_pixel{ 0 };
+		std::array< uint32_t, 4 >	m_bmp_masks{};							// The red, green, blue and alpha bits of a 32 bits pixel, the alpha mask is 0 if the pixels are opaque or if all their alpha is 0.
+
+		// TGA
+		uint32_t					m_tga_bytes_per_pixel{ 0 };
+		bool						m_tga_rle{ false };
+		uint32_t					m_tga_packet_remaining{ 0 };			// The number of pixels left in the current RLE packet.
+		bool						m_tga_packet_repeated{ false };			// The current RLE packet repeats a single pixel instead of listing raw ones.
+		sf::Color					m_tga_packet_color{};
+	};
+} // namespace Pixeler
@@ -0,0 +1,116 @@
+#include <vector>
+
+#include <SFML/Graphics/Image.hpp>
+
+#include <FZN/Tools/Logging.h>
+
+#include "Defines.h"
+#include "ImageDecoder.h"
+#include "ImageLoadJob.h"
+
+
+namespace Pixeler
+{
+	static constexpr float Decoding_Progress{ 0.9f };		// The part of the progress given to decoding the image, the rest is building its reduced levels.
+
+	/**
+	* @brief Start loading an image on a new thread.
+	* @param [in] _path The path of the image.
+	**/
+	ImageLoadJob::ImageLoadJob( std::string_view _path )
+		: m_path{ _path }
+		, m_thread{ [this]( std::stop_token _stop_token )
+		{
+			// The job is only finished once everything _load allocated has been freed, so destroying a finished job never waits.
+			_load( _stop_token );
+			m_finished.store( true, std::memory_order_release );
+		} }
+	{
+	}
+
+	/**
+	* @brief Take the loaded image once the job is finished.
+	* @return The loaded image, nullptr if the job isn't finished, failed or was cancelled.
+	**/
+	std::unique_ptr< ImageLoadJob::Result > ImageLoadJob::take_result()
+	{
+		if( is_finished() == false )
+			return nullptr;
+
+		return std::move( m_result );
+	}
+
+	/**
+	* @brief Decode the image and build its pixel store and reduced levels, checking for cancellation after each row of each step.
+	* sf::Image can't be interrupted, the formats it decodes are only cancelled once it returns.
+	* @param [in] _stop_token The token telling the thread to stop.
+	**/
+	void ImageLoadJob::_load( std::stop_token _stop_token )
+	{
+		auto result{ std::make_unique< Result > () };
+		ImageDecoder decoder;
+		const ImageDecoder::OpenResult open_result{ decoder.open( m_path ) };
+
+		if( open_result == ImageDecoder::OpenResult::too_large )
+		{
+			FZN_COLOR_LOG( fzn::DBG_MSG_COL_RED, "Failure : %s has too many pixels to be displayed", m_path.c_str() );
+			return;
+		}
+
+		if( open_result == ImageDecoder::OpenResult::opened )
+		{
+			// Only one row of the image is decoded at a time, straight into the pixel store.
+			const sf::Vector2u image_size{ decoder.get_size() };
+			std::vector< sf::Color > row( image_size.x );
+
+			result->m_pixels.create( image_size );
+
+			for( uint32_t nb_decoded_rows{ 0 }; nb_decoded_rows < image_size.y; ++nb_decoded_rows )
+			{
+				if( _stop_token.stop_requested() )
+					return;
+
+				const uint32_t row_index{ decoder.read_row( row ) };
+
+				// The rows decoded before an error are kept, the others stay transparent.
+				if( row_index == Uint32_Max )
+				{
+					FZN_COLOR_LOG( fzn::DBG_MSG_COL_RED, "Failure : only %u rows out of %u could be decoded from %s", nb_decoded_rows, image_size.y, m_path.c_str() );
+					break;
+				}
+
+				result->m_pixels.set_row( row_index, row );
+				m_progress.store( Decoding_Progress * ( nb_decoded_rows + 1 ) / image_size.y, std::memory_order_relaxed );
+			}
+		}
+		else
+		{
+			// Formats the decoder doesn't handle are decoded at once by SFML, still without creating a texture.
+			sf::Image image;
+
+			if( image.loadFromFile( m_path ) == false || _stop_token.stop_requested() )
+				return;
+
+			// The size of these formats is only known once they are decoded, the image is refused before the pixel store is created.
+			if( ImageDecoder::is_size_supported( image.getSize() ) == false )
+			{
+				FZN_COLOR_LOG( fzn::DBG_MSG_COL_RED, "Failure : %s has too many pixels to be displayed", m_path.c_str() );
+				return;
+			}
+
+			result->m_pixels.create( image.getSize(), image.getPixelsPtr(), _stop_token );
+			m_progress.store( Decoding_Progress, std::memory_order_relaxed );
+		}
+
+		if( _stop_token.stop_requested() || result->m_tiles.reset( result->m_pixels, _stop_token ) == false )
+			return;
+
+		result->m_opaque_rect = result->m_pixels.compute_opaque_rect( _stop_token );
+
+		if( _stop_token.stop_requested() )
+			return;
+
+		m_result = std::move( result );
+		m_progress.store( 1.f, std::memory_order_relaxed );
+	}
+} // namespace Pixeler
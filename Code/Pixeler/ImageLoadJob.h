@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <SFML/Graphics/Rect.hpp>
+
+#include "CanvasTiles.h"
+#include "PixelStore.h"
+
+
+namespace Pixeler
+{
+	/************************************************************************
+	* @brief Load an image on a worker thread: decode it into a new pixel store and build its reduced levels, while the canvas keeps displaying the previous one.
+	* The canvas polls the job once per frame and swaps the loaded image in when it's finished. Destroying the job cancels it and waits for its thread, so the canvas only destroys finished jobs.
+	************************************************************************/
+	class ImageLoadJob
+	{
+	public:
+		/************************************************************************
+		* @brief Everything the canvas needs to display the loaded image.
+		************************************************************************/
+		struct Result
+		{
+			PixelStore		m_pixels;
+			CanvasTiles		m_tiles;				// The tiles of the image and its reduced levels, without any texture yet.
+			sf::FloatRect	m_opaque_rect{};		// The smallest rectangle containing all the opaque pixels.
+		};
+
+		/**
+		* @brief Start loading an image on a new thread.
+		* @param [in] _path The path of the image.
+		**/
+		explicit ImageLoadJob( std::string_view _path );
+
+		/**
+		* @brief Ask the thread to stop after the row it is working on. It finishes without result.
+		**/
+		void cancel() { m_thread.request_stop(); }
+
+		bool				is_finished() const { return m_finished.load( std::memory_order_acquire ); }
+		float				get_progress() const { return m_progress.load( std::memory_order_relaxed ); }
+		const std::string&	get_path() const { return m_path; }
+
+		/**
+		* @brief Take the loaded image once the job is finished.
+		* @return The loaded image, nullptr if the job isn't finished, failed or was cancelled.
+		**/
+		std::unique_ptr< Result > take_result();
+
+	private:
+		/**
+		* @brief Decode the image and build its pixel store and reduced levels, checking for cancellation after each row of each step.
+		* sf::Image can't be interrupted, the formats it decodes are only cancelled once it returns.
+		* @param [in] _stop_token The token telling the thread to stop.
+		**/
+		void _load( std::stop_token _stop_token );
+
+		std::string					m_path;
+		std::unique_ptr< Result >	m_result;						// Written by the thread before it sets m_finished, only read after.
+		std::atomic< float >		m_progress{ 0.f };				// The loaded part of the image, from 0 to 1.
+		std::atomic< bool >			m_finished{ false };			// Set once _load returned and freed everything it allocated, the thread only has to exit.
+		std::jthread				m_thread;						// Declared last so it is stopped and joined before the other members are destroyed.
+	};
+} // namespace Pixeler
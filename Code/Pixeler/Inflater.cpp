@@ -0,0 +1,425 @@
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "Inflater.h"
+
+
+namespace Pixeler
+{
+	static constexpr size_t Input_Buffer_Size{ 65536 };
+
+	static constexpr uint16_t Length_Bases[ 29 ]{ 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	static constexpr uint8_t Length_Extra_Bits[ 29 ]{ 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	static constexpr uint16_t Distance_Bases[ 30 ]{ 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	static constexpr uint8_t Distance_Extra_Bits[ 30 ]{ 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	static constexpr uint8_t Code_Lengths_Order[ 19 ]{ 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	/**
+	* @param [in] _input The function giving the compressed bytes.
+	**/
+	Inflater::Inflater( InputFunction _input )
+		: m_input{ std::move( _input ) }
+		, m_input_buffer( Input_Buffer_Size )
+		, m_window( Window_Size, 0 )
+	{
+	}
+
+	/**
+	* @brief Decompress the next bytes of the stream.
+	* @param [out] _output	The buffer to fill.
+	* @param [in] _size		The number of bytes to decompress.
+	* @return False if the stream is corrupted or ends before the buffer is full.
+	**/
+	bool Inflater::read( uint8_t* _output, size_t _size )
+	{
+		if( m_header_read == false )
+		{
+			uint32_t method{ 0 };
+			uint32_t flags{ 0 };
+
+			if( _get_bits( 8, method ) == false || _get_bits( 8, flags ) == false )
+				return false;
+
+			// Deflate compression, valid header checksum and no preset dictionary.
+			if( ( method & 0x0F ) != 8 || ( ( method << 8 ) | flags ) % 31 != 0 || ( flags & 0x20 ) != 0 )
+				return false;
+
+			m_header_read = true;
+		}
+
+		const uint8_t* const output_end{ _output + _size };
+
+		while( _output < output_end )
+		{
+			if( m_match_remaining > 0 )
+			{
+				const size_t nb_copied_bytes{ std::min< size_t >( m_match_remaining, output_end - _output ) };
+
+				for( size_t byte{ 0 }; byte < nb_copied_bytes; ++byte )
+					_output_byte( m_window[ ( m_window_position - m_match_distance ) & ( Window_Size - 1 ) ], _output );
+
+				m_match_remaining -= static_cast< uint32_t >( nb_copied_bytes );
+				continue;
+			}
+
+			if( m_block_type == BlockType::none )
+			{
+				if( m_last_block || _read_block_header() == false )
+					return false;
+			}
+			else if( m_block_type == BlockType::stored )
+			{
+				uint32_t byte{ 0 };
+
+				if( m_stored_remaining == 0 )
+				{
+					m_block_type = BlockType::none;
+					continue;
+				}
+
+				if( _get_bits( 8, byte ) == false )
+					return false;
+
+				_output_byte( static_cast< uint8_t >( byte ), _output );
+				--m_stored_remaining;
+			}
+			else
+			{
+				uint32_t symbol{ 0 };
+
+				if( _decode( m_literals, symbol ) == false )
+					return false;
+
+				if( symbol < 256 )
+				{
+					_output_byte( static_cast< uint8_t >( symbol ), _output );
+					continue;
+				}
+
+				if( symbol == 256 )
+				{
+					m_block_type = BlockType::none;
+					continue;
+				}
+
+				const uint32_t length_code{ symbol - 257 };
+				uint32_t length_extra{ 0 };
+				uint32_t distance_code{ 0 };
+				uint32_t distance_extra{ 0 };
+
+				if( length_code >= std::size( Length_Bases ) || _get_bits( Length_Extra_Bits[ length_code ], length_extra ) == false )
+					return false;
+
+				if( _decode( m_distances, distance_code ) == false || distance_code >= std::size( Distance_Bases ) || _get_bits( Distance_Extra_Bits[ distance_code ], distance_extra ) == false )
+					return false;
+
+				m_match_remaining = Length_Bases[ length_code ] + length_extra;
+				m_match_distance = Distance_Bases[ distance_code ] + distance_extra;
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	* @brief Build the code from the length of the code of each symbol, 0 for unused symbols.
+	* @return False if there are more codes of a length than possible.
+	**/
+	bool Inflater::Huffman::build( const uint8_t* _lengths, uint32_t _nb_symbols )
+	{
+		m_counts.fill( 0 );
+		m_fast_table.fill( 0 );
+
+		for( uint32_t symbol{ 0 }; symbol < _nb_symbols; ++symbol )
+			++m_counts[ _lengths[ symbol ] ];
+
+		m_counts[ 0 ] = 0;
+
+		// Each length has twice as many possible codes as the previous one, minus the ones used by shorter codes.
+		int nb_available_codes{ 1 };
+		for( uint32_t length{ 1 }; length <= Max_Code_Length; ++length )
+		{
+			nb_available_codes = nb_available_codes * 2 - m_counts[ length ];
+
+			if( nb_available_codes < 0 )
+				return false;
+		}
+
+		std::array< uint16_t, Max_Code_Length + 1 > offsets{};
+		std::array< uint32_t, Max_Code_Length + 1 > next_codes{};
+		uint32_t code{ 0 };
+
+		for( uint32_t length{ 1 }; length <= Max_Code_Length; ++length )
+		{
+			offsets[ length ] = static_cast< uint16_t >( offsets[ length - 1 ] + m_counts[ length - 1 ] );
+			code = ( code + m_counts[ length - 1 ] ) << 1;
+			next_codes[ length ] = code;
+		}
+
+		for( uint32_t symbol{ 0 }; symbol < _nb_symbols; ++symbol )
+		{
+			const uint32_t length{ _lengths[ symbol ] };
+
+			if( length == 0 )
+				continue;
+
+			m_symbols[ offsets[ length ]++ ] = static_cast< uint16_t >( symbol );
+
+			const uint32_t symbol_code{ next_codes[ length ]++ };
+
+			if( length > Fast_Bits )
+				continue;
+
+			// The codes are stored starting with their most significant bit, the bit buffer starts with the least significant one.
+			uint32_t reversed_code{ 0 };
+			for( uint32_t bit{ 0 }; bit < length; ++bit )
+				reversed_code |= ( ( symbol_code >> bit ) & 1 ) << ( length - 1 - bit );
+
+			for( uint32_t entry{ reversed_code }; entry < m_fast_table.size(); entry += 1u << length )
+				m_fast_table[ entry ] = static_cast< uint16_t >( ( symbol << 4 ) | length );
+		}
+
+		return true;
+	}
+
+	bool Inflater::_read_block_header()
+	{
+		uint32_t last_block{ 0 };
+		uint32_t block_type{ 0 };
+
+		if( _get_bits( 1, last_block ) == false || _get_bits( 2, block_type ) == false )
+			return false;
+
+		m_last_block = last_block != 0;
+
+		if( block_type == 0 )
+		{
+			// Stored blocks start on a byte boundary.
+			m_bit_buffer >>= m_nb_bits % 8;
+			m_nb_bits -= m_nb_bits % 8;
+
+			uint32_t length{ 0 };
+			uint32_t length_complement{ 0 };
+
+			if( _get_bits( 16, length ) == false || _get_bits( 16, length_complement ) == false || length != ( ~length_complement & 0xFFFF ) )
+				return false;
+
+			m_stored_remaining = length;
+			m_block_type = BlockType::stored;
+			return true;
+		}
+
+		if( block_type == 1 )
+		{
+			std::array< uint8_t, 288 + 30 > lengths{};
+
+			std::fill( lengths.begin(), lengths.begin() + 144, uint8_t{ 8 } );
+			std::fill( lengths.begin() + 144, lengths.begin() + 256, uint8_t{ 9 } );
+			std::fill( lengths.begin() + 256, lengths.begin() + 280, uint8_t{ 7 } );
+			std::fill( lengths.begin() + 280, lengths.begin() + 288, uint8_t{ 8 } );
+			std::fill( lengths.begin() + 288, lengths.end(), uint8_t{ 5 } );
+
+			m_literals.build( lengths.data(), 288 );
+			m_distances.build( lengths.data() + 288, 30 );
+
+			m_block_type = BlockType::huffman;
+			return true;
+		}
+
+		if( block_type == 2 && _read_dynamic_codes() )
+		{
+			m_block_type = BlockType::huffman;
+			return true;
+		}
+
+		return false;
+	}
+
+	bool Inflater::_read_dynamic_codes()
+	{
+		uint32_t nb_literals{ 0 };
+		uint32_t nb_distances{ 0 };
+		uint32_t nb_code_lengths{ 0 };
+
+		if( _get_bits( 5, nb_literals ) == false || _get_bits( 5, nb_distances ) == false || _get_bits( 4, nb_code_lengths ) == false )
+			return false;
+
+		nb_literals += 257;
+		nb_distances += 1;
+		nb_code_lengths += 4;
+
+		if( nb_literals > 286 || nb_distances > 30 )
+			return false;
+
+		// The lengths of the literal and distance codes are themselves compressed with a code.
+		std::array< uint8_t, std::size( Code_Lengths_Order ) > code_lengths_lengths{};
+		Huffman code_lengths_code;
+
+		for( uint32_t code_length{ 0 }; code_length < nb_code_lengths; ++code_length )
+		{
+			uint32_t length{ 0 };
+
+			if( _get_bits( 3, length ) == false )
+				return false;
+
+			code_lengths_lengths[ Code_Lengths_Order[ code_length ] ] = static_cast< uint8_t >( length );
+		}
+
+		if( code_lengths_code.build( code_lengths_lengths.data(), static_cast< uint32_t >( code_lengths_lengths.size() ) ) == false )
+			return false;
+
+		std::array< uint8_t, 286 + 30 > lengths{};
+		uint32_t index{ 0 };
+
+		while( index < nb_literals + nb_distances )
+		{
+			uint32_t symbol{ 0 };
+
+			if( _decode( code_lengths_code, symbol ) == false )
+				return false;
+
+			if( symbol < 16 )
+			{
+				lengths[ index++ ] = static_cast< uint8_t >( symbol );
+				continue;
+			}
+
+			uint8_t repeated_length{ 0 };
+			uint32_t nb_repeats{ 0 };
+
+			if( symbol == 16 )
+			{
+				if( index == 0 || _get_bits( 2, nb_repeats ) == false )
+					return false;
+
+				repeated_length = lengths[ index - 1 ];
+				nb_repeats += 3;
+			}
+			else if( symbol == 17 )
+			{
+				if( _get_bits( 3, nb_repeats ) == false )
+					return false;
+
+				nb_repeats += 3;
+			}
+			else
+			{
+				if( _get_bits( 7, nb_repeats ) == false )
+					return false;
+
+				nb_repeats += 11;
+			}
+
+			if( index + nb_repeats > nb_literals + nb_distances )
+				return false;
+
+			std::fill_n( lengths.begin() + index, nb_repeats, repeated_length );
+			index += nb_repeats;
+		}
+
+		// A block without end of block code could never end.
+		if( lengths[ 256 ] == 0 )
+			return false;
+
+		return m_literals.build( lengths.data(), nb_literals ) && m_distances.build( lengths.data() + nb_literals, nb_distances );
+	}
+
+	/**
+	* @brief Read the next input byte.
+	* @return False at the end of the input.
+	**/
+	bool Inflater::_next_byte( uint8_t& _byte )
+	{
+		if( m_input_position == m_input_end )
+		{
+			m_input_position = 0;
+			m_input_end = m_input( m_input_buffer.data(), m_input_buffer.size() );
+
+			if( m_input_end == 0 )
+				return false;
+		}
+
+		_byte = m_input_buffer[ m_input_position++ ];
+		return true;
+	}
+
+	bool Inflater::_get_bits( uint32_t _nb_bits, uint32_t& _bits )
+	{
+		while( m_nb_bits < _nb_bits )
+		{
+			uint8_t byte{ 0 };
+
+			if( _next_byte( byte ) == false )
+				return false;
+
+			m_bit_buffer |= static_cast< uint64_t >( byte ) << m_nb_bits;
+			m_nb_bits += 8;
+		}
+
+		_bits = static_cast< uint32_t >( m_bit_buffer & ( ( uint64_t{ 1 } << _nb_bits ) - 1 ) );
+		m_bit_buffer >>= _nb_bits;
+		m_nb_bits -= _nb_bits;
+
+		return true;
+	}
+
+	bool Inflater::_decode( const Huffman& _huffman, uint32_t& _symbol )
+	{
+		// The end of the input can be reached before having as many bits as the longest code.
+		while( m_nb_bits < Max_Code_Length )
+		{
+			uint8_t byte{ 0 };
+
+			if( _next_byte( byte ) == false )
+				break;
+
+			m_bit_buffer |= static_cast< uint64_t >( byte ) << m_nb_bits;
+			m_nb_bits += 8;
+		}
+
+		const uint16_t entry{ _huffman.m_fast_table[ m_bit_buffer & ( ( 1u << Fast_Bits ) - 1 ) ] };
+		const uint32_t entry_length{ entry & 0x0Fu };
+
+		if( entry != 0 && entry_length <= m_nb_bits )
+		{
+			_symbol = entry >> 4;
+			m_bit_buffer >>= entry_length;
+			m_nb_bits -= entry_length;
+			return true;
+		}
+
+		// Longer codes are decoded bit by bit: the codes of a length follow the last code of the previous length.
+		int code{ 0 };
+		int first_code{ 0 };
+		int first_index{ 0 };
+
+		for( uint32_t length{ 1 }; length <= Max_Code_Length && length <= m_nb_bits; ++length )
+		{
+			code |= static_cast< int >( ( m_bit_buffer >> ( length - 1 ) ) & 1 );
+
+			const int count{ _huffman.m_counts[ length ] };
+
+			if( code - count < first_code )
+			{
+				_symbol = _huffman.m_symbols[ first_index + ( code - first_code ) ];
+				m_bit_buffer >>= length;
+				m_nb_bits -= length;
+				return true;
+			}
+
+			first_index += count;
+			first_code = ( first_code + count ) << 1;
+			code <<= 1;
+		}
+
+		return false;
+	}
+
+	void Inflater::_output_byte( uint8_t _byte, uint8_t*& _output )
+	{
+		*_output++ = _byte;
+		m_window[ m_window_position ] = _byte;
+		m_window_position = ( m_window_position + 1 ) & ( Window_Size - 1 );
+	}
+} // namespace Pixeler
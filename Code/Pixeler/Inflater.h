@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <vector>
+
+
+namespace Pixeler
+{
+	/************************************************************************
+	* @brief Decompress a zlib stream (RFC 1950 and 1951) piece by piece, keeping only the last 32KB of output and a small input buffer in memory.
+	* Used to decode PNG image data one row at a time. The Adler-32 checksum at the end of the stream isn't checked.
+	************************************************************************/
+	class Inflater
+	{
+	public:
+		using InputFunction = std::function< size_t( uint8_t*, size_t ) >;	// Fill a buffer with the next compressed bytes and return how many were written, 0 at the end of the input.
+
+		/**
+		* @param [in] _input The function giving the compressed bytes.
+		**/
+		explicit Inflater( InputFunction _input );
+
+		/**
+		* @brief Decompress the next bytes of the stream.
+		* @param [out] _output	The buffer to fill.
+		* @param [in] _size		The number of bytes to decompress.
+		* @return False if the stream is corrupted or ends before the buffer is full.
+		**/
+		bool read( uint8_t* _output, size_t _size );
+
+	private:
+		static constexpr uint32_t Max_Code_Length{ 15 };
+		static constexpr uint32_t Fast_Bits{ 10 };							// Codes up to this length are decoded with a single table lookup.
+		static constexpr size_t Window_Size{ 32768 };						// The farthest back a match can copy from.
+
+		/************************************************************************
+		* @brief A canonical Huffman code, given by the number of codes of each length and the symbols sorted by code.
+		************************************************************************/
+		struct Huffman
+		{
+			/**
+			* @brief Build the code from the length of the code of each symbol, 0 for unused symbols.
+			* @return False if there are more codes of a length than possible.
+			**/
+			bool build( const uint8_t* _lengths, uint32_t _nb_symbols );
+
+			std::array< uint16_t, Max_Code_Length + 1 >	m_counts{};
+			std::array< uint16_t, 288 >					m_symbols{};
+			std::array< uint16_t, 1 << Fast_Bits >		m_fast_table{};		// The symbol and code length of each value of the next Fast_Bits bits, 0 if the code is longer.
+		};
+
+		enum class BlockType
+		{
+			none,			// The next block header has to be read.
+			stored,
+			huffman,
+		};
+
+		bool _read_block_header();
+		bool _read_dynamic_codes();
+
+		/**
+		* @brief Read the next input byte.
+		* @return False at the end of the input.
+		**/
+		bool _next_byte( uint8_t& _byte );
+
+		bool _get_bits( uint32_t _nb_bits, uint32_t& _bits );
+		bool _decode( const Huffman& _huffman, uint32_t& _symbol );
+
+		void _output_byte( uint8_t _byte, uint8_t*& _output );
+
+		InputFunction				m_input;
+		std::vector< uint8_t >		m_input_buffer;
+		size_t						m_input_position{ 0 };
+		size_t						m_input_end{ 0 };
+
+		uint64_t					m_bit_buffer{ 0 };
+		uint32_t					m_nb_bits{ 0 };
+
+		bool						m_header_read{ false };				// The 2 bytes zlib header has been checked.
+		bool						m_last_block{ false };
+		BlockType					m_block_type{ BlockType::none };
+		uint32_t					m_stored_remaining{ 0 };			// The number of bytes left in the current stored block.
+		uint32_t					m_match_remaining{ 0 };				// The number of bytes left to copy from the current match.
+		uint32_t					m_match_distance{ 0 };
+		Huffman						m_literals;							// The code of the literals, the end of block and the match lengths.
+		Huffman						m_distances;						// The code of the match distances.
+
+		std::vector< uint8_t >		m_window;							// The last bytes written, matches copy from it.
+		size_t						m_window_position{ 0 };
+	};
+} // namespace Pixeler
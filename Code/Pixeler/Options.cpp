@@ -27,6 +27,10 @@ namespace Pixeler
 		ImGui::MenuItem( "Show Pixel Grid",			g_pFZN_InputMgr->GetActionKeyString( Action_ShowGrid, true ).c_str(),			&m_options_datas.m_show_grid );
 		if( ImGui::IsItemHovered() )
 			ImGui::SetTooltip( Tooltip_ShowGrid );
+
+		ImGui::MenuItem( "Show Minimap", nullptr, &m_options_datas.m_show_minimap );
+		if( ImGui::IsItemHovered() )
+			ImGui::SetTooltip( Tooltip_ShowMinimap );
 	}
 
 	void Options::bottom_bar_options()
@@ -149,6 +153,33 @@ namespace Pixeler
 
 				ImGui::EndTable();
 			}
+			ImGui::SeparatorText( "Conversion" );
+
+			if( _begin_option_table( column_width ) )
+			{
+				_first_column_text( "Exact color matching" );
+				second_column_widget( ImGui::Checkbox( "##Exact color matching", &m_options_datas.m_exact_color_matching ) );
+				ImGui::SameLine();
+				ImGui_fzn::helper_simple_tooltip( "Always find the closest palette color to a pixel.\nWhen unchecked, pixels close to the limit between two palette colors may be approximated, making conversions a bit faster." );
+
+				ImGui::TableNextRow();
+				_first_column_text( "Color distance" );
+				ImGui::SetNextItemWidth( ImGui::GetContentRegionAvail().x - ImGui::GetFrameHeight() - ImGui::GetStyle().ItemSpacing.x );
+				if( ImGui::BeginCombo( "##Color distance", ColorDistance_Names[ static_cast< int >( m_options_datas.m_color_distance ) ] ) )
+				{
+					for( int distance{ 0 }; distance < static_cast< int >( ColorDistance::COUNT ); ++distance )
+					{
+						if( second_column_widget( ImGui_fzn::bold_selectable( ColorDistance_Names[ distance ], static_cast< int >( m_options_datas.m_color_distance ) == distance ) ) )
+							m_options_datas.m_color_distance = static_cast< ColorDistance >( distance );
+					}
+
+					ImGui::EndCombo();
+				}
+				ImGui::SameLine();
+				ImGui_fzn::helper_simple_tooltip( "How the difference between a pixel and the palette colors is measured.\nRGB is the fastest. Redmean, OKLab and CIELAB follow human perception more closely, especially in dark and blue tones.\nCIELAB dE2000 is the most accurate but also the slowest.\nOnly the next conversions will use it." );
+
+				ImGui::EndTable();
+			}
 
 			_draw_keybinds( column_width );
 
@@ -313,8 +344,11 @@ namespace Pixeler
 		m_options_datas.m_area_highlight_thickness = root[ "area_highlight_thickness" ].asFloat();
 		m_options_datas.m_grid_same_color_as_canvas = root[ "grid_same_color_as_canvas" ].asBool();
 		m_options_datas.m_show_grid = root[ "show_grid" ].asBool();
+		m_options_datas.m_show_minimap = root.get( "show_minimap", true ).asBool();
 		m_options_datas.m_show_secondary_highlight = root[ "show_secondary_highlight" ].asBool();
 		m_options_datas.m_area_secondary_highlight_thickness = root[ "area_secondary_highlight_thickness" ].asFloat();
+		m_options_datas.m_exact_color_matching = root.get( "exact_color_matching", true ).asBool();
+		m_options_datas.m_color_distance = static_cast< ColorDistance >( std::min( root.get( "color_distance", 0 ).asUInt(), static_cast< Json::Value::UInt >( ColorDistance::COUNT ) - 1 ) );
 
 		m_options_datas.m_window_size.x = std::max( root[ "window_size" ][ 0 ].asUInt(), 800u );
 		m_options_datas.m_window_size.y = std::max( root[ "window_size" ][ 1 ].asUInt(), 600u );
@@ -353,8 +387,11 @@ namespace Pixeler
 		root[ "area_highlight_thickness" ] = m_options_datas.m_area_highlight_thickness;
 		root[ "grid_same_color_as_canvas" ] = m_options_datas.m_grid_same_color_as_canvas;
 		root[ "show_grid" ] = m_options_datas.m_show_grid;
+		root[ "show_minimap" ] = m_options_datas.m_show_minimap;
 		root[ "show_secondary_highlight" ] = m_options_datas.m_show_secondary_highlight;
 		root[ "area_secondary_highlight_thickness" ] = m_options_datas.m_area_secondary_highlight_thickness;
+		root[ "exact_color_matching" ] = m_options_datas.m_exact_color_matching;
+		root[ "color_distance" ] = static_cast< Json::Value::UInt >( m_options_datas.m_color_distance );
 
 		root[ "window_size" ][ 0 ] = m_options_datas.m_window_size.x;
 		root[ "window_size" ][ 1 ] = m_options_datas.m_window_size.y;
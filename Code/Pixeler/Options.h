@@ -4,6 +4,8 @@
 #include <FZN/UI/ImGuiAdditions.h>
 #include <FZN/Managers/InputManager.h>
 
+#include "ColorSpaces.h"
+
 
 namespace Pixeler
 {
@@ -24,10 +26,14 @@ namespace Pixeler
 
 			bool	m_grid_same_color_as_canvas{ true };
 			bool	m_show_grid{ true };
+			bool	m_show_minimap{ true };		// Display an overview of the image at the bottom right corner of the canvas.
 
 			float	m_original_opacity_pct{ 100.f };
 			bool	m_show_original{ false };
 
+			bool	m_exact_color_matching{ true };		// Compare the pixels with all the possible closest colors of the palette instead of using the approximations of the color lookup table.
+			ColorDistance m_color_distance{ ColorDistance::RGB };	// The way the difference between a pixel and the palette colors is measured.
+
 			sf::Vector2u m_window_size{ 1280, 720 };	// The size of the window when it's not in fullscreen.
 
 			std::vector< fzn::ActionKey > m_bindings;
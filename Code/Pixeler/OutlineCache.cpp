@@ -0,0 +1,54 @@
+#include "OutlineCache.h"
+
+
+namespace Pixeler
+{
+	static constexpr size_t Max_Cached_Corners{ size_t{ 1 } << 22 };		// About 32MB of corners, far more than the outlines of a hovered color usually need.
+
+	/**
+	* @brief Get the contours of an area, tracing them if they aren't in the cache.
+	* @param [in] _labels	The labels of the areas of the image.
+	* @param [in] _area		The label of the area.
+	* @return The contours of the area, valid until the next call.
+	**/
+	const AreaLabels::Contours& OutlineCache::get_contours( AreaLabels& _labels, uint32_t _area )
+	{
+		if( auto entry{ m_entries.find( _area ) }; entry != m_entries.end() )
+		{
+			m_usage_order.splice( m_usage_order.begin(), m_usage_order, entry->second.m_usage_position );
+			return entry->second.m_contours;
+		}
+
+		AreaLabels::Contours contours;
+		_labels.trace_contours( _area, contours );
+		m_nb_corners += contours.m_corners.size();
+
+		// The new contours are kept even if they are bigger than the cache on their own, the other areas are removed first.
+		while( m_nb_corners > Max_Cached_Corners && m_usage_order.empty() == false )
+		{
+			const auto least_used_entry{ m_entries.find( m_usage_order.back() ) };
+
+			m_nb_corners -= least_used_entry->second.m_contours.m_corners.size();
+			m_entries.erase( least_used_entry );
+			m_usage_order.pop_back();
+		}
+
+		m_usage_order.push_front( _area );
+
+		Entry& entry{ m_entries[ _area ] };
+		entry.m_contours = std::move( contours );
+		entry.m_usage_position = m_usage_order.begin();
+
+		return entry.m_contours;
+	}
+
+	/**
+	* @brief Remove all the contours, after the areas have been labeled again.
+	**/
+	void OutlineCache::clear()
+	{
+		m_entries.clear();
+		m_usage_order.clear();
+		m_nb_corners = 0;
+	}
+} // namespace Pixeler
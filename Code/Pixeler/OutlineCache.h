@@ -0,0 +1,48 @@
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+#include "AreaLabels.h"
+
+
+namespace Pixeler
+{
+	/************************************************************************
+	* @brief The contours of the areas outlined on the canvas, in image space and by area label, so they are only traced once per conversion.
+	* They don't depend on the zoom level or the position of the image: the canvas transform is applied to their corners when the outlines are built.
+	* The least recently used areas are removed once the contours hold too many corners, so images with many areas keep a bounded cache.
+	************************************************************************/
+	class OutlineCache
+	{
+	public:
+		/**
+		* @brief Get the contours of an area, tracing them if they aren't in the cache.
+		* @param [in] _labels	The labels of the areas of the image.
+		* @param [in] _area		The label of the area.
+		* @return The contours of the area, valid until the next call.
+		**/
+		const AreaLabels::Contours& get_contours( AreaLabels& _labels, uint32_t _area );
+
+		/**
+		* @brief Remove all the contours, after the areas have been labeled again.
+		**/
+		void clear();
+
+		size_t get_nb_corners() const { return m_nb_corners; }
+
+	private:
+		/************************************************************************
+		* @brief The contours of an area and its position in the usage order.
+		************************************************************************/
+		struct Entry
+		{
+			AreaLabels::Contours			m_contours;
+			std::list< uint32_t >::iterator	m_usage_position;
+		};
+
+		std::unordered_map< uint32_t, Entry >	m_entries;						// The contours of each cached area, by area label.
+		std::list< uint32_t >					m_usage_order;					// The cached areas, from the most recently used to the least.
+		size_t									m_nb_corners{ 0 };				// The number of corners of all the cached contours.
+	};
+} // namespace Pixeler
@@ -0,0 +1,184 @@
+#include <algorithm>
+
+#include "PaletteKDTree.h"
+#include "Utils.h"
+
+
+namespace Pixeler
+{
+	static constexpr uint32_t Max_Colors_Per_Leaf{ 8 };
+
+	/**
+	* @brief Check if the tree has to be built again because the given palette is not the one used for the last build, or its colors or selection changed since then.
+	* @param [in] _palette The palette to compare with the tree content.
+	* @return True if the tree isn't up to date.
+	**/
+	bool PaletteKDTree::needs_rebuild( const ColorPalette& _palette ) const
+	{
+		if( m_palette != &_palette )
+			return true;
+
+		return m_signature != _palette.compute_selection_signature();
+	}
+
+	/**
+	* @brief Build the tree from the selected colors of the given palette.
+	* @param [in] _palette The palette to use.
+	**/
+	void PaletteKDTree::build( const ColorPalette& _palette )
+	{
+		clear();
+
+		m_palette = &_palette;
+		m_signature = _palette.compute_selection_signature();
+
+		for( uint16_t color_index{ 0 }; color_index < _palette.m_colors.size() && color_index < Invalid_Index; ++color_index )
+		{
+			if( _palette.m_colors[ color_index ].m_selected )
+				m_colors.push_back( { _palette.m_colors[ color_index ].m_color, color_index } );
+		}
+
+		if( m_colors.size() <= Brute_Force_Max_Colors )
+			return;
+
+		// A balanced tree has less than two nodes per leaf color.
+		m_nodes.reserve( m_colors.size() * 2 );
+		m_nodes.push_back( {} );
+		_build_node( 0, 0, static_cast< uint32_t >( m_colors.size() ) );
+	}
+
+	/**
+	* @brief Empty the tree, it will have to be built again before being used.
+	**/
+	void PaletteKDTree::clear()
+	{
+		m_colors.clear();
+		m_nodes.clear();
+		m_palette = nullptr;
+		m_signature = 0;
+	}
+
+	/**
+	* @brief Find the closest selected palette color to the given one.
+	* @param [in] _color The color to look for.
+	* @return The index of the closest color in the palette colors vector. Invalid_Index if there is no selected color.
+	**/
+	uint16_t PaletteKDTree::find_color_index( const sf::Color& _color ) const
+	{
+		if( m_colors.empty() )
+			return Invalid_Index;
+
+		const ImColor converted_color{ Utils::to_imcolor( _color ) };
+		uint32_t closest_color{ 0 };
+		float smallest_distance{ Flt_Max };
+
+		if( m_nodes.empty() )
+			_search_range( 0, static_cast< uint32_t >( m_colors.size() ), converted_color, closest_color, smallest_distance );
+		else
+			_search( m_nodes.front(), converted_color, closest_color, smallest_distance );
+
+		return m_colors[ closest_color ].m_palette_index;
+	}
+
+
+	/**
+	* @brief Fill the given node with a range of colors and create its children if it contains too many colors to be a leaf.
+	* @param [in] _node_index	The index of the node in m_nodes.
+	* @param [in] _first_color	The first color of the node in m_colors.
+	* @param [in] _last_color	The index after the last color of the node in m_colors.
+	**/
+	void PaletteKDTree::_build_node( uint32_t _node_index, uint32_t _first_color, uint32_t _last_color )
+	{
+		m_nodes[ _node_index ].m_first_color = _first_color;
+		m_nodes[ _node_index ].m_last_color = _last_color;
+
+		if( _last_color - _first_color <= Max_Colors_Per_Leaf )
+			return;
+
+		// The node is split along the channel on which its colors are the most spread.
+		ImVec4 min_values{ Flt_Max, Flt_Max, Flt_Max, 0.f };
+		ImVec4 max_values{ -Flt_Max, -Flt_Max, -Flt_Max, 0.f };
+
+		for( uint32_t color{ _first_color }; color < _last_color; ++color )
+		{
+			const ImVec4& value{ m_colors[ color ].m_color.Value };
+
+			min_values = { std::min( min_values.x, value.x ), std::min( min_values.y, value.y ), std::min( min_values.z, value.z ), 0.f };
+			max_values = { std::max( max_values.x, value.x ), std::max( max_values.y, value.y ), std::max( max_values.z, value.z ), 0.f };
+		}
+
+		const ImVec4 extents{ max_values.x - min_values.x, max_values.y - min_values.y, max_values.z - min_values.z, 0.f };
+		uint8_t split_channel{ 0 };
+
+		if( extents.y > extents.x && extents.y >= extents.z )
+			split_channel = 1;
+		else if( extents.z > extents.x && extents.z > extents.y )
+			split_channel = 2;
+
+		// Median split: every color before the median has a lower or equal value on the split channel, every color after it a greater or equal value.
+		const uint32_t median{ _first_color + ( _last_color - _first_color ) / 2 };
+
+		std::nth_element( m_colors.begin() + _first_color, m_colors.begin() + median, m_colors.begin() + _last_color, [split_channel]( const TreeColor& _color_a, const TreeColor& _color_b )
+		{
+			return _get_channel( _color_a.m_color, split_channel ) < _get_channel( _color_b.m_color, split_channel );
+		} );
+
+		const float split_value{ _get_channel( m_colors[ median ].m_color, split_channel ) };
+
+		// Both children are created before their own children so the right one always follows the left one.
+		const uint32_t left_child{ static_cast< uint32_t >( m_nodes.size() ) };
+		m_nodes.push_back( {} );
+		m_nodes.push_back( {} );
+
+		m_nodes[ _node_index ].m_left_child = left_child;
+		m_nodes[ _node_index ].m_split_value = split_value;
+		m_nodes[ _node_index ].m_split_channel = split_channel;
+
+		_build_node( left_child, _first_color, median );
+		_build_node( left_child + 1, median, _last_color );
+	}
+
+	/**
+	* @brief Look for a closer color than the current one in the given node and its children.
+	* @param [in]		_node				The node to search.
+	* @param [in]		_color				The color to look for.
+	* @param [in,out]	_closest_color		The closest color found so far (index in m_colors).
+	* @param [in,out]	_smallest_distance	The distance to the closest color found so far.
+	**/
+	void PaletteKDTree::_search( const Node& _node, const ImColor& _color, uint32_t& _closest_color, float& _smallest_distance ) const
+	{
+		if( _node.is_leaf() )
+		{
+			_search_range( _node.m_first_color, _node.m_last_color, _color, _closest_color, _smallest_distance );
+			return;
+		}
+
+		// The child on the side of the color is searched first, the other one only if it can contain a color at least as close as the current one.
+		const float split_distance{ _get_channel( _color, _node.m_split_channel ) - _node.m_split_value };
+		const Node& near_child{ m_nodes[ _node.m_left_child + ( split_distance > 0.f ? 1 : 0 ) ] };
+		const Node& far_child{ m_nodes[ _node.m_left_child + ( split_distance > 0.f ? 0 : 1 ) ] };
+
+		_search( near_child, _color, _closest_color, _smallest_distance );
+
+		// Equal distances are still searched, as an earlier color in the palette would have to replace the current one.
+		if( split_distance * split_distance <= _smallest_distance )
+			_search( far_child, _color, _closest_color, _smallest_distance );
+	}
+
+	/**
+	* @brief Compare the given color with a range of colors, updating the closest color if one of them is closer, or as close and before it in the palette.
+	**/
+	void PaletteKDTree::_search_range( uint32_t _first_color, uint32_t _last_color, const ImColor& _color, uint32_t& _closest_color, float& _smallest_distance ) const
+	{
+		for( uint32_t color{ _first_color }; color < _last_color; ++color )
+		{
+			const float distance{ get_color_distance( _color, m_colors[ color ].m_color ) };
+
+			if( distance < _smallest_distance || ( distance == _smallest_distance && m_colors[ color ].m_palette_index < m_colors[ _closest_color ].m_palette_index ) )
+			{
+				_smallest_distance = distance;
+				_closest_color = color;
+			}
+		}
+	}
+} // namespace Pixeler
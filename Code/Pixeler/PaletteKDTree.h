@@ -0,0 +1,110 @@
+#pragma once
+
+#include <vector>
+
+#include <SFML/Graphics/Color.hpp>
+
+#include "ColorPalette.h"
+
+
+namespace Pixeler
+{
+	/************************************************************************
+	* @brief k-d tree over the selected colors of a palette, used to find the closest one to a color without comparing it with the whole palette.
+	* Searches are exact: they return the same color as an exhaustive search would, including the first color in palette order in case of equal distances.
+	* Small palettes aren't worth a tree and are simply compared with every selected color.
+	************************************************************************/
+	class PaletteKDTree
+	{
+	public:
+		static constexpr uint16_t	Invalid_Index{ std::numeric_limits< uint16_t >::max() };
+		static constexpr size_t		Brute_Force_Max_Colors{ 16 };		// Under this number of selected colors, no tree is built.
+
+		/**
+		* @brief Check if the tree has to be built again because the given palette is not the one used for the last build, or its colors or selection changed since then.
+		* @param [in] _palette The palette to compare with the tree content.
+		* @return True if the tree isn't up to date.
+		**/
+		bool needs_rebuild( const ColorPalette& _palette ) const;
+
+		/**
+		* @brief Build the tree from the selected colors of the given palette.
+		* @param [in] _palette The palette to use.
+		**/
+		void build( const ColorPalette& _palette );
+
+		/**
+		* @brief Empty the tree, it will have to be built again before being used.
+		**/
+		void clear();
+
+		/**
+		* @brief Check if the last build has been made with the given palette.
+		* @param [in] _palette The palette to check.
+		* @return True if the tree can be used with this palette.
+		**/
+		bool is_built_for( const ColorPalette* _palette ) const { return _palette != nullptr && m_palette == _palette; }
+
+		/**
+		* @brief Find the closest selected palette color to the given one.
+		* @param [in] _color The color to look for.
+		* @return The index of the closest color in the palette colors vector. Invalid_Index if there is no selected color.
+		**/
+		uint16_t find_color_index( const sf::Color& _color ) const;
+
+	private:
+		/************************************************************************
+		* @brief A selected color of the palette.
+		************************************************************************/
+		struct TreeColor
+		{
+			ImColor		m_color;
+			uint16_t	m_palette_index{ Invalid_Index };		// The index of the color in the palette colors vector.
+		};
+
+		/************************************************************************
+		* @brief A node of the tree, splitting its colors in two halves along one channel. Leaves directly contain a few colors.
+		************************************************************************/
+		struct Node
+		{
+			static constexpr uint32_t Leaf{ std::numeric_limits< uint32_t >::max() };
+
+			bool is_leaf() const { return m_left_child == Leaf; }
+
+			uint32_t	m_first_color{ 0 };				// The first color of the node in m_colors.
+			uint32_t	m_last_color{ 0 };				// The index after the last color of the node in m_colors.
+			uint32_t	m_left_child{ Leaf };			// Colors lower or equal to the split value on the split channel. The right child is always placed right after the left one.
+			float		m_split_value{ 0.f };
+			uint8_t		m_split_channel{ 0 };
+		};
+
+		/**
+		* @brief Fill the given node with a range of colors and create its children if it contains too many colors to be a leaf.
+		* @param [in] _node_index	The index of the node in m_nodes.
+		* @param [in] _first_color	The first color of the node in m_colors.
+		* @param [in] _last_color	The index after the last color of the node in m_colors.
+		**/
+		void _build_node( uint32_t _node_index, uint32_t _first_color, uint32_t _last_color );
+
+		/**
+		* @brief Look for a closer color than the current one in the given node and its children.
+		* @param [in]		_node				The node to search.
+		* @param [in]		_color				The color to look for.
+		* @param [in,out]	_closest_color		The closest color found so far (index in m_colors).
+		* @param [in,out]	_smallest_distance	The distance to the closest color found so far.
+		**/
+		void _search( const Node& _node, const ImColor& _color, uint32_t& _closest_color, float& _smallest_distance ) const;
+
+		/**
+		* @brief Compare the given color with a range of colors, updating the closest color if one of them is closer, or as close and before it in the palette.
+		**/
+		void _search_range( uint32_t _first_color, uint32_t _last_color, const ImColor& _color, uint32_t& _closest_color, float& _smallest_distance ) const;
+
+		static float _get_channel( const ImColor& _color, uint8_t _channel ) { return ( &_color.Value.x )[ _channel ]; }
+
+		std::vector< TreeColor >	m_colors;					// The selected colors of the palette, in palette order for brute force searches, reordered by the tree nodes otherwise.
+		std::vector< Node >			m_nodes;					// The nodes of the tree, the first one being the root. Empty when using brute force.
+		const ColorPalette*			m_palette{ nullptr };		// The palette used for the last build.
+		uint64_t					m_signature{ 0 };			// The signature of the palette at the time of the last build.
+	};
+} // namespace Pixeler
@@ -0,0 +1,228 @@
+#include "PaletteLookupTable.h"
+#include "Utils.h"
+
+
+namespace Pixeler
+{
+	/**
+	* @brief Check if the table has to be built again because the given palette is not the one used for the last build, or its colors or selection changed since then.
+	* @param [in] _palette The palette to compare with the table content.
+	* @return True if the table isn't up to date.
+	**/
+	bool PaletteLookupTable::needs_rebuild( const ColorPalette& _palette ) const
+	{
+		if( m_palette != &_palette || m_cells.empty() )
+			return true;
+
+		return m_signature != _palette.compute_selection_signature();
+	}
+
+	/**
+	* @brief Compute the closest selected color of the given palette for every cell of the table.
+	* @param [in] _palette The palette the table will be built from. Only its selected colors will be used.
+	**/
+	void PaletteLookupTable::build( const ColorPalette& _palette )
+	{
+		clear();
+
+		m_palette = &_palette;
+		m_signature = _palette.compute_selection_signature();
+
+		for( uint16_t color_index{ 0 }; color_index < _palette.m_colors.size() && color_index < Invalid_Index; ++color_index )
+		{
+			if( _palette.m_colors[ color_index ].m_selected )
+				m_colors.push_back( { _palette.m_colors[ color_index ].m_color, color_index } );
+		}
+
+		m_cells.resize( Cells_Per_Channel * Cells_Per_Channel * Cells_Per_Channel );
+
+		if( m_colors.empty() )
+			return;
+
+		std::vector< uint16_t > candidates( m_colors.size() );
+
+		for( uint16_t candidate{ 0 }; candidate < candidates.size(); ++candidate )
+			candidates[ candidate ] = candidate;
+
+		_build_box( { 0, 0, 0 }, 256, candidates );
+	}
+
+	/**
+	* @brief Empty the table, it will have to be built again before being used.
+	**/
+	void PaletteLookupTable::clear()
+	{
+		m_cells.clear();
+		m_candidates.clear();
+		m_colors.clear();
+		m_palette = nullptr;
+		m_signature = 0;
+	}
+
+	/**
+	* @brief Check if the last build has been made with the given palette.
+	* @param [in] _palette The palette to check.
+	* @return True if the table has been built and can be used with this palette.
+	**/
+	bool PaletteLookupTable::is_built_for( const ColorPalette* _palette ) const
+	{
+		return _palette != nullptr && m_palette == _palette && m_cells.empty() == false;
+	}
+
+	/**
+	* @brief Find the closest selected palette color to the given one.
+	* @param [in] _color The color to look for.
+	* @return The index of the closest color in the palette colors vector. Invalid_Index if there is no selected color.
+	**/
+	uint16_t PaletteLookupTable::find_color_index( const sf::Color& _color ) const
+	{
+		if( m_cells.empty() )
+			return Invalid_Index;
+
+		const Cell& cell{ m_cells[ _get_cell_index( _color.r >> Cell_Bits, _color.g >> Cell_Bits, _color.b >> Cell_Bits ) ] };
+
+		if( cell.m_nb_candidates == 0 || m_exact_refinement == false )
+			return cell.m_color_index;
+
+		return _find_closest_candidate( Utils::to_imcolor( _color ), &m_candidates[ cell.m_first_candidate ], cell.m_nb_candidates );
+	}
+
+
+	/**
+	* @brief Reduce the list of colors that can be the closest to the values of the given box, and fill its cells when it is small enough or when only one color remains.
+	* @param [in] _box_min		The lowest value of each channel in the box.
+	* @param [in] _box_size		The number of values in each channel of the box.
+	* @param [in] _candidates	The colors that could be the closest ones in the parent box (indexes in m_colors).
+	**/
+	void PaletteLookupTable::_build_box( const std::array< uint32_t, 3 >& _box_min, uint32_t _box_size, const std::vector< uint16_t >& _candidates )
+	{
+		// Bounds of the box, in the same unit as the colors of the palette.
+		std::array< float, 3 > box_low;
+		std::array< float, 3 > box_high;
+
+		for( int channel{ 0 }; channel < 3; ++channel )
+		{
+			box_low[ channel ] = _box_min[ channel ] / 255.f;
+			box_high[ channel ] = ( _box_min[ channel ] + _box_size - 1 ) / 255.f;
+		}
+
+		// For each candidate, the smallest and biggest distances it can have with a value of the box.
+		std::vector< float > min_distances( _candidates.size() );
+		float smallest_max_distance{ Flt_Max };
+
+		for( size_t candidate{ 0 }; candidate < _candidates.size(); ++candidate )
+		{
+			const ImVec4& color{ m_colors[ _candidates[ candidate ] ].m_color.Value };
+			const std::array< float, 3 > channels{ color.x, color.y, color.z };
+
+			float min_distance{ 0.f };
+			float max_distance{ 0.f };
+
+			for( int channel{ 0 }; channel < 3; ++channel )
+			{
+				const float to_low{ channels[ channel ] - box_low[ channel ] };
+				const float to_high{ box_high[ channel ] - channels[ channel ] };
+
+				if( to_low < 0.f )
+					min_distance += to_low * to_low;
+				else if( to_high < 0.f )
+					min_distance += to_high * to_high;
+
+				max_distance += std::max( to_low * to_low, to_high * to_high );
+			}
+
+			min_distances[ candidate ] = min_distance;
+			smallest_max_distance = std::min( smallest_max_distance, max_distance );
+		}
+
+		// A color can't be the closest to a value of the box if it is always farther than the color with the smallest maximum distance.
+		// The margin keeps rounding differences with the exact distance computation from excluding a real candidate.
+		const float candidate_threshold{ smallest_max_distance * 1.0001f + 1e-6f };
+		std::vector< uint16_t > remaining_candidates;
+
+		for( size_t candidate{ 0 }; candidate < _candidates.size(); ++candidate )
+		{
+			if( min_distances[ candidate ] <= candidate_threshold )
+				remaining_candidates.push_back( _candidates[ candidate ] );
+		}
+
+		if( remaining_candidates.size() == 1 )
+		{
+			_fill_box( _box_min, _box_size, m_colors[ remaining_candidates.front() ].m_palette_index );
+			return;
+		}
+
+		if( _box_size > Cell_Size )
+		{
+			const uint32_t half_size{ _box_size / 2 };
+
+			for( uint32_t red{ 0 }; red < 2; ++red )
+			{
+				for( uint32_t green{ 0 }; green < 2; ++green )
+				{
+					for( uint32_t blue{ 0 }; blue < 2; ++blue )
+						_build_box( { _box_min[ 0 ] + red * half_size, _box_min[ 1 ] + green * half_size, _box_min[ 2 ] + blue * half_size }, half_size, remaining_candidates );
+				}
+			}
+
+			return;
+		}
+
+		// The box is a single cell with several possible closest colors, we keep them to compare them with the exact color later.
+		Cell& cell{ m_cells[ _get_cell_index( _box_min[ 0 ] >> Cell_Bits, _box_min[ 1 ] >> Cell_Bits, _box_min[ 2 ] >> Cell_Bits ) ] };
+
+		cell.m_first_candidate = static_cast< uint32_t >( m_candidates.size() );
+		cell.m_nb_candidates = static_cast< uint16_t >( remaining_candidates.size() );
+
+		for( uint16_t candidate : remaining_candidates )
+			m_candidates.push_back( m_colors[ candidate ].m_palette_index );
+
+		const float half_cell{ ( Cell_Size - 1 ) * 0.5f };
+		const ImColor cell_center{ ( _box_min[ 0 ] + half_cell ) / 255.f, ( _box_min[ 1 ] + half_cell ) / 255.f, ( _box_min[ 2 ] + half_cell ) / 255.f };
+
+		cell.m_color_index = _find_closest_candidate( cell_center, &m_candidates[ cell.m_first_candidate ], cell.m_nb_candidates );
+	}
+
+	/**
+	* @brief Set the same closest color to all the cells of a box.
+	**/
+	void PaletteLookupTable::_fill_box( const std::array< uint32_t, 3 >& _box_min, uint32_t _box_size, uint16_t _palette_index )
+	{
+		const uint32_t first_cell[ 3 ]{ _box_min[ 0 ] >> Cell_Bits, _box_min[ 1 ] >> Cell_Bits, _box_min[ 2 ] >> Cell_Bits };
+		const uint32_t nb_cells{ std::max( _box_size >> Cell_Bits, 1u ) };
+
+		for( uint32_t red{ first_cell[ 0 ] }; red < first_cell[ 0 ] + nb_cells; ++red )
+		{
+			for( uint32_t green{ first_cell[ 1 ] }; green < first_cell[ 1 ] + nb_cells; ++green )
+			{
+				for( uint32_t blue{ first_cell[ 2 ] }; blue < first_cell[ 2 ] + nb_cells; ++blue )
+					m_cells[ _get_cell_index( red, green, blue ) ] = { _palette_index, 0, 0 };
+			}
+		}
+	}
+
+	uint16_t PaletteLookupTable::_find_closest_candidate( const ImColor& _color, const uint16_t* _candidates, uint32_t _nb_candidates ) const
+	{
+		// Candidates are in palette order and only the strictly closer colors replace the current one, exactly like a search through the whole palette would do.
+		uint16_t closest_color{ Invalid_Index };
+		float smallest_distance{ Flt_Max };
+
+		for( uint32_t candidate{ 0 }; candidate < _nb_candidates; ++candidate )
+		{
+			const float distance{ get_color_distance( _color, m_palette->m_colors[ _candidates[ candidate ] ].m_color ) };
+
+			if( distance < smallest_distance )
+			{
+				smallest_distance = distance;
+				closest_color = _candidates[ candidate ];
+			}
+		}
+
+		return closest_color;
+	}
+
+	uint32_t PaletteLookupTable::_get_cell_index( uint32_t _red, uint32_t _green, uint32_t _blue )
+	{
+		return ( _red * Cells_Per_Channel + _green ) * Cells_Per_Channel + _blue;
+	}
+} // namespace Pixeler
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <SFML/Graphics/Color.hpp>
+
+#include "ColorPalette.h"
+
+
+namespace Pixeler
+{
+	/************************************************************************
+	* @brief Precomputed table giving the closest selected palette color of any RGB value.
+	* The RGB cube is split in 64x64x64 cells. Each cell either knows the only palette color that can be the closest to its values,
+	* or the short list of candidates that can be, which are then compared to the exact color (exact refinement).
+	* With exact refinement, results are identical to a comparison with every color of the palette.
+	************************************************************************/
+	class PaletteLookupTable
+	{
+	public:
+		static constexpr uint16_t Invalid_Index{ std::numeric_limits< uint16_t >::max() };
+
+		/**
+		* @brief Check if the table has to be built again because the given palette is not the one used for the last build, or its colors or selection changed since then.
+		* @param [in] _palette The palette to compare with the table content.
+		* @return True if the table isn't up to date.
+		**/
+		bool needs_rebuild( const ColorPalette& _palette ) const;
+
+		/**
+		* @brief Compute the closest selected color of the given palette for every cell of the table.
+		* @param [in] _palette The palette the table will be built from. Only its selected colors will be used.
+		**/
+		void build( const ColorPalette& _palette );
+
+		/**
+		* @brief Empty the table, it will have to be built again before being used.
+		**/
+		void clear();
+
+		/**
+		* @brief Check if the last build has been made with the given palette.
+		* @param [in] _palette The palette to check.
+		* @return True if the table has been built and can be used with this palette.
+		**/
+		bool is_built_for( const ColorPalette* _palette ) const;
+
+		/**
+		* @brief Find the closest selected palette color to the given one.
+		* @param [in] _color The color to look for.
+		* @return The index of the closest color in the palette colors vector. Invalid_Index if there is no selected color.
+		**/
+		uint16_t find_color_index( const sf::Color& _color ) const;
+
+		/**
+		* @brief Activate or deactivate the comparison with the candidates of cells that have more than one possible closest color.
+		* Without it, the color closest to the center of those cells will be used, which is faster but can differ from an exhaustive search.
+		**/
+		void set_exact_refinement( bool _exact_refinement ) { m_exact_refinement = _exact_refinement; }
+		bool is_using_exact_refinement() const { return m_exact_refinement; }
+
+	private:
+		static constexpr uint32_t Cell_Bits{ 2 };							// Number of low bits ignored on each channel to find the cell of a color. A cell contains 4 values per channel.
+		static constexpr uint32_t Cell_Size{ 1 << Cell_Bits };
+		static constexpr uint32_t Cells_Per_Channel{ 256 >> Cell_Bits };
+
+		/************************************************************************
+		* @brief A part of the RGB cube and the palette colors that can be the closest to its values.
+		************************************************************************/
+		struct Cell
+		{
+			uint16_t	m_color_index{ Invalid_Index };		// The palette color closest to the center of the cell. The closest one for all its values if there are no candidates.
+			uint16_t	m_nb_candidates{ 0 };				// The number of colors that can be the closest to a value of the cell, 0 if m_color_index is always the closest.
+			uint32_t	m_first_candidate{ 0 };				// The index of the first candidate in m_candidates.
+		};
+
+		/************************************************************************
+		* @brief A selected color of the palette.
+		************************************************************************/
+		struct TableColor
+		{
+			ImColor		m_color;
+			uint16_t	m_palette_index{ Invalid_Index };	// The index of the color in the palette colors vector.
+		};
+
+
+		/**
+		* @brief Reduce the list of colors that can be the closest to the values of the given box, and fill its cells when it is small enough or when only one color remains.
+		* @param [in] _box_min		The lowest value of each channel in the box.
+		* @param [in] _box_size		The number of values in each channel of the box.
+		* @param [in] _candidates	The colors that could be the closest ones in the parent box (indexes in m_colors).
+		**/
+		void _build_box( const std::array< uint32_t, 3 >& _box_min, uint32_t _box_size, const std::vector< uint16_t >& _candidates );
+
+		/**
+		* @brief Set the same closest color to all the cells of a box.
+		**/
+		void _fill_box( const std::array< uint32_t, 3 >& _box_min, uint32_t _box_size, uint16_t _palette_index );
+
+		uint16_t _find_closest_candidate( const ImColor& _color, const uint16_t* _candidates, uint32_t _nb_candidates ) const;
+
+		static uint32_t _get_cell_index( uint32_t _red, uint32_t _green, uint32_t _blue );
+
+		std::vector< Cell >			m_cells;							// Cells of the table, blue channel varying the fastest.
+		std::vector< uint16_t >		m_candidates;						// Candidate lists of all the cells having several possible closest colors (indexes in m_colors).
+		std::vector< TableColor >	m_colors;							// The selected colors of the palette, in palette order.
+		const ColorPalette*			m_palette{ nullptr };				// The palette used for the last build.
+		uint64_t					m_signature{ 0 };					// The signature of the palette at the time of the last build.
+		bool						m_exact_refinement{ true };
+	};
+} // namespace Pixeler
@@ -0,0 +1,603 @@
+#include <algorithm>
+#include <bit>
+#include <ranges>
+#include <type_traits>
+
+#include <FZN/Tools/Logging.h>
+
+#include "ColorMetrics.h"
+#include "PaletteSnapshot.h"
+
+#if defined( _M_X64 ) || defined( _M_IX86 ) || defined( __x86_64__ ) || defined( __i386__ )
+	#define PIXELER_X86 1
+	#include <immintrin.h>
+
+	#if defined( _MSC_VER )
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#else
+	#define PIXELER_X86 0
+#endif
+
+// MSVC lets any function use the intrinsics of any instruction set, GCC and Clang need to be told which functions can.
+#if defined( __GNUC__ ) || defined( __clang__ )
+	#define PIXELER_TARGET( _instruction_set ) __attribute__( ( target( _instruction_set ) ) )
+#else
+	#define PIXELER_TARGET( _instruction_set )
+#endif
+
+
+namespace Pixeler
+{
+	static constexpr size_t Padding_Alignment{ 16 };	// The number of colors compared in each iteration of the widest kernel.
+	static constexpr float	Padding_Value{ 1e16f };		// Green value of the padding colors, far enough from any color to never be the closest one, close enough to keep distances finite. Their other channels are 0.
+	static constexpr size_t Min_SIMD_Colors{ 32 };		// Under this number of selected colors, merging the results of the lanes costs more than what the SIMD kernels save.
+	static constexpr size_t Max_Inserted_Candidates{ 16 };	// Up to this number of candidates, they are kept sorted while going through the distances instead of sorting all the distances.
+
+	/**
+	* @brief Signature of the functions looking for the closest snapshot color to a color.
+	* @return The position of the closest color in the snapshot arrays.
+	**/
+	using ClosestColorKernel = uint32_t (*)( const float* _reds, const float* _greens, const float* _blues, size_t _nb_colors, const ImVec4& _color );
+
+	/**
+	* @brief Signature of the functions computing the distances between a color and all the snapshot colors.
+	**/
+	using DistancesKernel = void (*)( const float* _reds, const float* _greens, const float* _blues, size_t _nb_colors, const ImVec4& _color, float* _distances );
+
+	/**
+	* @brief Scalar kernel, also used for the distances having no SIMD version.
+	**/
+	template< typename DistanceMetric >
+	static uint32_t find_closest_color_scalar( const float* _reds, const float* _greens, const float* _blues, size_t _nb_colors, const ImVec4& _color )
+	{
+		uint32_t closest_color{ 0 };
+		float smallest_distance{ Flt_Max };
+
+		for( uint32_t color{ 0 }; color < _nb_colors; ++color )
+		{
+			const ImVec4 palette_color{ _reds[ color ], _greens[ color ], _blues[ color ], 1.f };
+
+			// A color whose distance can't be smaller than the smallest one can't replace it either.
+			if constexpr( DistanceMetric::Use_Lower_Bound )
+			{
+				if( DistanceMetric::get_lower_bound( _color, palette_color ) >= smallest_distance )
+					continue;
+			}
+
+			const float distance{ DistanceMetric::get_distance( _color, palette_color ) };
+
+			if( distance < smallest_distance )
+			{
+				smallest_distance = distance;
+				closest_color = color;
+			}
+		}
+
+		return closest_color;
+	}
+
+	template< typename DistanceMetric >
+	static void compute_distances_scalar( const float* _reds, const float* _greens, const float* _blues, size_t _nb_colors, const ImVec4& _color, float* _distances )
+	{
+		for( size_t color{ 0 }; color < _nb_colors; ++color )
+			_distances[ color ] = DistanceMetric::get_distance( _color, { _reds[ color ], _greens[ color ], _blues[ color ], 1.f } );
+	}
+
+	/**
+	* @brief Find the closest color among the best ones of each lane of a kernel: the smallest distance, and the first color in case of equal distances.
+	**/
+	static uint32_t reduce_lanes( const float* _distances, const uint32_t* _colors, uint32_t _nb_lanes )
+	{
+		uint32_t closest_lane{ 0 };
+
+		for( uint32_t lane{ 1 }; lane < _nb_lanes; ++lane )
+		{
+			if( _distances[ lane ] < _distances[ closest_lane ] || ( _distances[ lane ] == _distances[ closest_lane ] && _colors[ lane ] < _colors[ closest_lane ] ) )
+				closest_lane = lane;
+		}
+
+		return _colors[ closest_lane ];
+	}
+
+#if PIXELER_X86
+	// Each lane keeps the first of its colors with the smallest distance, replacing it only by strictly closer ones, the same way the scalar version does.
+	// Distances are computed with the same operations in the same order as ColorSpaces::get_distance, without fused multiply-add, so they are identical.
+
+	template< typename DistanceMetric >
+	PIXELER_TARGET( "sse4.1" )
+	static inline __m128 get_distances_sse41( const __m128& _red, const __m128& _green, const __m128& _blue, const float* _reds, const float* _greens, const float* _blues )
+	{
+		const __m128 reds{ _mm_loadu_ps( _reds ) };
+		const __m128 red_diff{ _mm_sub_ps( reds, _red ) };
+		const __m128 green_diff{ _mm_sub_ps( _mm_loadu_ps( _greens ), _green ) };
+		const __m128 blue_diff{ _mm_sub_ps( _mm_loadu_ps( _blues ), _blue ) };
+		const __m128 red_squared{ _mm_mul_ps( red_diff, red_diff ) };
+		const __m128 green_squared{ _mm_mul_ps( green_diff, green_diff ) };
+		const __m128 blue_squared{ _mm_mul_ps( blue_diff, blue_diff ) };
+
+		if constexpr( std::is_same_v< DistanceMetric, Metric::Redmean > )
+		{
+			const __m128 mean_red{ _mm_mul_ps( _mm_mul_ps( _mm_add_ps( _red, reds ), _mm_set1_ps( 0.5f ) ), _mm_set1_ps( 255.f ) ) };
+			const __m128 red_weight{ _mm_add_ps( _mm_set1_ps( DistanceMetric::Base_Weight ), _mm_mul_ps( mean_red, _mm_set1_ps( DistanceMetric::Red_Scale ) ) ) };
+			const __m128 blue_weight{ _mm_add_ps( _mm_set1_ps( DistanceMetric::Base_Weight ), _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( 255.f ), mean_red ), _mm_set1_ps( DistanceMetric::Red_Scale ) ) ) };
+
+			return _mm_add_ps( _mm_add_ps( _mm_mul_ps( red_weight, red_squared ), _mm_mul_ps( _mm_set1_ps( DistanceMetric::Green_Weight ), green_squared ) ), _mm_mul_ps( blue_weight, blue_squared ) );
+		}
+		else
+			return _mm_add_ps( _mm_add_ps( red_squared, green_squared ), blue_squared );
+	}
+
+	template< typename DistanceMetric >
+	PIXELER_TARGET( "sse4.1" )
+	static uint32_t find_closest_color_sse41( const float* _reds, const float* _greens, const float* _blues, size_t _nb_colors, const ImVec4& _color )
+	{
+		const __m128 red{ _mm_set1_ps( _color.x ) };
+		const __m128 green{ _mm_set1_ps( _color.y ) };
+		const __m128 blue{ _mm_set1_ps( _color.z ) };
+		const __m128i lane_step{ _mm_set1_epi32( 8 ) };
+
+		// Two independent sets of lanes (low and high), so a comparison doesn't have to wait for the result of the previous one.
+		__m128 smallest_distances_low{ _mm_set1_ps( Flt_Max ) };
+		__m128 smallest_distances_high{ _mm_set1_ps( Flt_Max ) };
+		__m128i closest_colors_low{ _mm_setzero_si128() };
+		__m128i closest_colors_high{ _mm_setzero_si128() };
+		__m128i colors_low{ _mm_setr_epi32( 0, 1, 2, 3 ) };
+		__m128i colors_high{ _mm_setr_epi32( 4, 5, 6, 7 ) };
+
+		for( size_t color{ 0 }; color < _nb_colors; color += 8 )
+		{
+			const __m128 distances_low{ get_distances_sse41< DistanceMetric >( red, green, blue, _reds + color, _greens + color, _blues + color ) };
+			const __m128 distances_high{ get_distances_sse41< DistanceMetric >( red, green, blue, _reds + color + 4, _greens + color + 4, _blues + color + 4 ) };
+			const __m128 closer_low{ _mm_cmplt_ps( distances_low, smallest_distances_low ) };
+			const __m128 closer_high{ _mm_cmplt_ps( distances_high, smallest_distances_high ) };
+
+			smallest_distances_low = _mm_blendv_ps( smallest_distances_low, distances_low, closer_low );
+			smallest_distances_high = _mm_blendv_ps( smallest_distances_high, distances_high, closer_high );
+			closest_colors_low = _mm_blendv_epi8( closest_colors_low, colors_low, _mm_castps_si128( closer_low ) );
+			closest_colors_high = _mm_blendv_epi8( closest_colors_high, colors_high, _mm_castps_si128( closer_high ) );
+			colors_low = _mm_add_epi32( colors_low, lane_step );
+			colors_high = _mm_add_epi32( colors_high, lane_step );
+		}
+
+		alignas( 16 ) float lane_distances[ 8 ];
+		alignas( 16 ) uint32_t lane_colors[ 8 ];
+		_mm_store_ps( lane_distances, smallest_distances_low );
+		_mm_store_ps( lane_distances + 4, smallest_distances_high );
+		_mm_store_si128( reinterpret_cast< __m128i* >( lane_colors ), closest_colors_low );
+		_mm_store_si128( reinterpret_cast< __m128i* >( lane_colors + 4 ), closest_colors_high );
+
+		return reduce_lanes( lane_distances, lane_colors, 8 );
+	}
+
+	template< typename DistanceMetric >
+	PIXELER_TARGET( "sse4.1" )
+	static void compute_distances_sse41( const float* _reds, const float* _greens, const float* _blues, size_t _nb_colors, const ImVec4& _color, float* _distances )
+	{
+		const __m128 red{ _mm_set1_ps( _color.x ) };
+		const __m128 green{ _mm_set1_ps( _color.y ) };
+		const __m128 blue{ _mm_set1_ps( _color.z ) };
+
+		for( size_t color{ 0 }; color < _nb_colors; color += 4 )
+			_mm_storeu_ps( _distances + color, get_distances_sse41< DistanceMetric >( red, green, blue, _reds + color, _greens + color, _blues + color ) );
+	}
+
+	template< typename DistanceMetric >
+	PIXELER_TARGET( "avx2" )
+	static inline __m256 get_distances_avx2( const __m256& _red, const __m256& _green, const __m256& _blue, const float* _reds, const float* _greens, const float* _blues )
+	{
+		const __m256 reds{ _mm256_loadu_ps( _reds ) };
+		const __m256 red_diff{ _mm256_sub_ps( reds, _red ) };
+		const __m256 green_diff{ _mm256_sub_ps( _mm256_loadu_ps( _greens ), _green ) };
+		const __m256 blue_diff{ _mm256_sub_ps( _mm256_loadu_ps( _blues ), _blue ) };
+		const __m256 red_squared{ _mm256_mul_ps( red_diff, red_diff ) };
+		const __m256 green_squared{ _mm256_mul_ps( green_diff, green_diff ) };
+		const __m256 blue_squared{ _mm256_mul_ps( blue_diff, blue_diff ) };
+
+		if constexpr( std::is_same_v< DistanceMetric, Metric::Redmean > )
+		{
+			const __m256 mean_red{ _mm256_mul_ps( _mm256_mul_ps( _mm256_add_ps( _red, reds ), _mm256_set1_ps( 0.5f ) ), _mm256_set1_ps( 255.f ) ) };
+			const __m256 red_weight{ _mm256_add_ps( _mm256_set1_ps( DistanceMetric::Base_Weight ), _mm256_mul_ps( mean_red, _mm256_set1_ps( DistanceMetric::Red_Scale ) ) ) };
+			const __m256 blue_weight{ _mm256_add_ps( _mm256_set1_ps( DistanceMetric::Base_Weight ), _mm256_mul_ps( _mm256_sub_ps( _mm256_set1_ps( 255.f ), mean_red ), _mm256_set1_ps( DistanceMetric::Red_Scale ) ) ) };
+
+			return _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( red_weight, red_squared ), _mm256_mul_ps( _mm256_set1_ps( DistanceMetric::Green_Weight ), green_squared ) ), _mm256_mul_ps( blue_weight, blue_squared ) );
+		}
+		else
+			return _mm256_add_ps( _mm256_add_ps( red_squared, green_squared ), blue_squared );
+	}
+
+	template< typename DistanceMetric >
+	PIXELER_TARGET( "avx2" )
+	static uint32_t find_closest_color_avx2( const float* _reds, const float* _greens, const float* _blues, size_t _nb_colors, const ImVec4& _color )
+	{
+		const __m256 red{ _mm256_set1_ps( _color.x ) };
+		const __m256 green{ _mm256_set1_ps( _color.y ) };
+		const __m256 blue{ _mm256_set1_ps( _color.z ) };
+		const __m256i lane_step{ _mm256_set1_epi32( 16 ) };
+
+		// Two independent sets of lanes (low and high), so a comparison doesn't have to wait for the result of the previous one.
+		__m256 smallest_distances_low{ _mm256_set1_ps( Flt_Max ) };
+		__m256 smallest_distances_high{ _mm256_set1_ps( Flt_Max ) };
+		__m256i closest_colors_low{ _mm256_setzero_si256() };
+		__m256i closest_colors_high{ _mm256_setzero_si256() };
+		__m256i colors_low{ _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ) };
+		__m256i colors_high{ _mm256_setr_epi32( 8, 9, 10, 11, 12, 13, 14, 15 ) };
+
+		for( size_t color{ 0 }; color < _nb_colors; color += 16 )
+		{
+			const __m256 distances_low{ get_distances_avx2< DistanceMetric >( red, green, blue, _reds + color, _greens + color, _blues + color ) };
+			const __m256 distances_high{ get_distances_avx2< DistanceMetric >( red, green, blue, _reds + color + 8, _greens + color + 8, _blues + color + 8 ) };
+			const __m256 closer_low{ _mm256_cmp_ps( distances_low, smallest_distances_low, _CMP_LT_OQ ) };
+			const __m256 closer_high{ _mm256_cmp_ps( distances_high, smallest_distances_high, _CMP_LT_OQ ) };
+
+			smallest_distances_low = _mm256_blendv_ps( smallest_distances_low, distances_low, closer_low );
+			smallest_distances_high = _mm256_blendv_ps( smallest_distances_high, distances_high, closer_high );
+			closest_colors_low = _mm256_blendv_epi8( closest_colors_low, colors_low, _mm256_castps_si256( closer_low ) );
+			closest_colors_high = _mm256_blendv_epi8( closest_colors_high, colors_high, _mm256_castps_si256( closer_high ) );
+			colors_low = _mm256_add_epi32( colors_low, lane_step );
+			colors_high = _mm256_add_epi32( colors_high, lane_step );
+		}
+
+		alignas( 32 ) float lane_distances[ 16 ];
+		alignas( 32 ) uint32_t lane_colors[ 16 ];
+		_mm256_store_ps( lane_distances, smallest_distances_low );
+		_mm256_store_ps( lane_distances + 8, smallest_distances_high );
+		_mm256_store_si256( reinterpret_cast< __m256i* >( lane_colors ), closest_colors_low );
+		_mm256_store_si256( reinterpret_cast< __m256i* >( lane_colors + 8 ), closest_colors_high );
+
+		return reduce_lanes( lane_distances, lane_colors, 16 );
+	}
+
+	template< typename DistanceMetric >
+	PIXELER_TARGET( "avx2" )
+	static void compute_distances_avx2( const float* _reds, const float* _greens, const float* _blues, size_t _nb_colors, const ImVec4& _color, float* _distances )
+	{
+		const __m256 red{ _mm256_set1_ps( _color.x ) };
+		const __m256 green{ _mm256_set1_ps( _color.y ) };
+		const __m256 blue{ _mm256_set1_ps( _color.z ) };
+
+		for( size_t color{ 0 }; color < _nb_colors; color += 8 )
+			_mm256_storeu_ps( _distances + color, get_distances_avx2< DistanceMetric >( red, green, blue, _reds + color, _greens + color, _blues + color ) );
+	}
+
+	static void cpuid( int _registers[ 4 ], int _leaf, int _sub_leaf )
+	{
+	#if defined( _MSC_VER )
+		__cpuidex( _registers, _leaf, _sub_leaf );
+	#else
+		unsigned int eax{ 0 }, ebx{ 0 }, ecx{ 0 }, edx{ 0 };
+		__cpuid_count( _leaf, _sub_leaf, eax, ebx, ecx, edx );
+		_registers[ 0 ] = static_cast< int >( eax );
+		_registers[ 1 ] = static_cast< int >( ebx );
+		_registers[ 2 ] = static_cast< int >( ecx );
+		_registers[ 3 ] = static_cast< int >( edx );
+	#endif
+	}
+
+	/**
+	* @brief Check if the operating system saves the AVX registers on context switches, without which AVX instructions can't be used even if the processor supports them.
+	**/
+	static bool is_avx_state_enabled()
+	{
+	#if defined( _MSC_VER )
+		const uint64_t enabled_states{ _xgetbv( 0 ) };
+	#else
+		uint32_t eax{ 0 }, edx{ 0 };
+		__asm__( "xgetbv" : "=a"( eax ), "=d"( edx ) : "c"( 0 ) );
+		const uint64_t enabled_states{ ( static_cast< uint64_t >( edx ) << 32 ) | eax };
+	#endif
+
+		// SSE and AVX states.
+		return ( enabled_states & 0x6 ) == 0x6;
+	}
+#endif
+
+	static PaletteSnapshot::Kernel detect_kernel()
+	{
+	#if PIXELER_X86
+		int registers[ 4 ]{ 0 };
+
+		cpuid( registers, 0, 0 );
+		const int max_leaf{ registers[ 0 ] };
+
+		cpuid( registers, 1, 0 );
+		const bool sse41{ ( registers[ 2 ] & ( 1 << 19 ) ) != 0 };
+		const bool os_saves_avx{ ( registers[ 2 ] & ( 1 << 27 ) ) != 0 && is_avx_state_enabled() };
+		const bool avx{ ( registers[ 2 ] & ( 1 << 28 ) ) != 0 && os_saves_avx };
+
+		bool avx2{ false };
+
+		if( avx && max_leaf >= 7 )
+		{
+			cpuid( registers, 7, 0 );
+			avx2 = ( registers[ 1 ] & ( 1 << 5 ) ) != 0;
+		}
+
+		if( avx2 )
+			return PaletteSnapshot::Kernel::AVX2;
+
+		if( sse41 )
+			return PaletteSnapshot::Kernel::SSE41;
+	#endif
+
+		return PaletteSnapshot::Kernel::Scalar;
+	}
+
+	template< typename DistanceMetric >
+	static ClosestColorKernel get_kernel_function( PaletteSnapshot::Kernel _kernel )
+	{
+	#if PIXELER_X86
+		switch( _kernel )
+		{
+			case PaletteSnapshot::Kernel::AVX2:		return find_closest_color_avx2< DistanceMetric >;
+			case PaletteSnapshot::Kernel::SSE41:	return find_closest_color_sse41< DistanceMetric >;
+			default:								break;
+		}
+	#endif
+
+		return find_closest_color_scalar< DistanceMetric >;
+	}
+
+	static ClosestColorKernel get_kernel_function( PaletteSnapshot::Kernel _kernel, ColorDistance _distance )
+	{
+		switch( _distance )
+		{
+			// Euclidean distances only differ by the coordinates of the colors.
+			case ColorDistance::RGB:
+			case ColorDistance::OKLab:
+			case ColorDistance::CIE76:		return get_kernel_function< Metric::RGB >( _kernel );
+			case ColorDistance::Redmean:	return get_kernel_function< Metric::Redmean >( _kernel );
+			default:						return find_closest_color_scalar< Metric::CIE2000 >;
+		}
+	}
+
+	template< typename DistanceMetric >
+	static DistancesKernel get_distances_function( PaletteSnapshot::Kernel _kernel )
+	{
+	#if PIXELER_X86
+		switch( _kernel )
+		{
+			case PaletteSnapshot::Kernel::AVX2:		return compute_distances_avx2< DistanceMetric >;
+			case PaletteSnapshot::Kernel::SSE41:	return compute_distances_sse41< DistanceMetric >;
+			default:								break;
+		}
+	#endif
+
+		return compute_distances_scalar< DistanceMetric >;
+	}
+
+	static DistancesKernel get_distances_function( PaletteSnapshot::Kernel _kernel, ColorDistance _distance )
+	{
+		switch( _distance )
+		{
+			case ColorDistance::RGB:
+			case ColorDistance::OKLab:
+			case ColorDistance::CIE76:		return get_distances_function< Metric::RGB >( _kernel );
+			case ColorDistance::Redmean:	return get_distances_function< Metric::Redmean >( _kernel );
+			default:						return compute_distances_scalar< Metric::CIE2000 >;
+		}
+	}
+
+	/**
+	* @brief Find the positions of the smallest distances, sorted by distance and then by position.
+	* @param [in]	_distances		The distances to sort.
+	* @param [out]	_positions		The positions of the smallest distances. Its size is the number of distances to keep.
+	* @param [out]	_sort_buffer	A buffer used when a lot of distances are kept, to avoid allocations.
+	**/
+	static void find_smallest_distances( std::span< const float > _distances, std::span< uint32_t > _positions, std::vector< uint64_t >& _sort_buffer )
+	{
+		const size_t nb_kept{ _positions.size() };
+
+		if( nb_kept == 0 )
+			return;
+
+		if( nb_kept > Max_Inserted_Candidates )
+		{
+			// Distances are never negative, so their bits compare in the same order as their values. The position in the low bits puts equal distances in position order.
+			_sort_buffer.resize( _distances.size() );
+
+			for( uint32_t position{ 0 }; position < _distances.size(); ++position )
+				_sort_buffer[ position ] = ( static_cast< uint64_t >( std::bit_cast< uint32_t >( _distances[ position ] ) ) << 32 ) | position;
+
+			std::ranges::nth_element( _sort_buffer, _sort_buffer.begin() + ( nb_kept - 1 ) );
+			std::sort( _sort_buffer.begin(), _sort_buffer.begin() + nb_kept );
+			std::ranges::transform( _sort_buffer | std::views::take( nb_kept ), _positions.begin(), []( uint64_t _key ) { return static_cast< uint32_t >( _key ); } );
+			return;
+		}
+
+		// Most distances are bigger than the last kept one and are skipped right away. The others are inserted after all the kept ones that are closer or as close, so equal distances stay in position order.
+		size_t nb_found{ 0 };
+
+		for( uint32_t position{ 0 }; position < _distances.size(); ++position )
+		{
+			const float distance{ _distances[ position ] };
+
+			if( nb_found == nb_kept && ( distance < _distances[ _positions[ nb_kept - 1 ] ] ) == false )
+				continue;
+
+			size_t insertion{ std::min( nb_found, nb_kept - 1 ) };
+
+			while( insertion > 0 && distance < _distances[ _positions[ insertion - 1 ] ] )
+			{
+				_positions[ insertion ] = _positions[ insertion - 1 ];
+				--insertion;
+			}
+
+			_positions[ insertion ] = position;
+			nb_found = std::min( nb_found + 1, nb_kept );
+		}
+	}
+
+	static const char* get_kernel_name( PaletteSnapshot::Kernel _kernel )
+	{
+		switch( _kernel )
+		{
+			case PaletteSnapshot::Kernel::AVX2:		return "AVX2";
+			case PaletteSnapshot::Kernel::SSE41:	return "SSE4.1";
+			default:								return "scalar";
+		}
+	}
+
+
+	/**
+	* @brief Check if the snapshot has to be built again because the given palette or distance are not the ones used for the last build, or the colors or selection of the palette changed since then.
+	* @param [in] _palette		The palette to compare with the snapshot content.
+	* @param [in] _distance	The distance that will be used to compare the colors.
+	* @param [in] _all_colors	True if the snapshot contains all the colors of the palette, in which case their selection doesn't matter.
+	* @return True if the snapshot isn't up to date.
+	**/
+	bool PaletteSnapshot::needs_rebuild( const ColorPalette& _palette, ColorDistance _distance, bool _all_colors /*= false*/ ) const
+	{
+		if( m_palette != &_palette || m_distance != _distance || m_all_colors != _all_colors )
+			return true;
+
+		return m_signature != ( _all_colors ? _palette.compute_colors_signature() : _palette.compute_selection_signature() );
+	}
+
+	/**
+	* @brief Copy the selected colors of the given palette.
+	* @param [in] _palette		The palette to use.
+	* @param [in] _distance	The distance that will be used to compare the colors. The snapshot contains the coordinates of the colors for this distance.
+	* @param [in] _all_colors	Copy all the colors of the palette, selected or not. Used to rank the palette colors with rank_colors.
+	**/
+	void PaletteSnapshot::build( const ColorPalette& _palette, ColorDistance _distance, bool _all_colors /*= false*/ )
+	{
+		clear();
+
+		m_palette = &_palette;
+		m_signature = _all_colors ? _palette.compute_colors_signature() : _palette.compute_selection_signature();
+		m_distance = _distance;
+		m_all_colors = _all_colors;
+
+		for( uint16_t color_index{ 0 }; color_index < _palette.m_colors.size() && color_index < Invalid_Index; ++color_index )
+		{
+			const ColorInfos& color{ _palette.m_colors[ color_index ] };
+
+			if( color.m_selected == false && _all_colors == false )
+				continue;
+
+			const ImVec4& coordinates{ color.get_coordinates( _distance ) };
+
+			m_reds.push_back( coordinates.x );
+			m_greens.push_back( coordinates.y );
+			m_blues.push_back( coordinates.z );
+			m_palette_indices.push_back( color_index );
+		}
+
+		m_nb_colors = m_palette_indices.size();
+
+		const size_t padded_size{ ( m_nb_colors + Padding_Alignment - 1 ) / Padding_Alignment * Padding_Alignment };
+		m_reds.resize( padded_size, 0.f );
+		m_greens.resize( padded_size, Padding_Value );
+		m_blues.resize( padded_size, 0.f );
+
+		FZN_DBLOG( "Palette snapshot of %zu %s colors (%s distance), using %s kernel.", m_nb_colors, _all_colors ? "palette" : "selected", ColorDistance_Names[ static_cast< int >( _distance ) ], get_kernel_name( _get_used_kernel() ) );
+	}
+
+	/**
+	* @brief Empty the snapshot, it will have to be built again before being used.
+	**/
+	void PaletteSnapshot::clear()
+	{
+		m_reds.clear();
+		m_greens.clear();
+		m_blues.clear();
+		m_palette_indices.clear();
+		m_nb_colors = 0;
+		m_palette = nullptr;
+		m_signature = 0;
+	}
+
+	/**
+	* @brief Find the closest selected palette color of each of the given colors. Alpha is ignored.
+	* @param [in]	_colors				The colors to convert.
+	* @param [out]	_palette_indices	The index in the palette colors vector of the closest color to each color, Invalid_Index if there is no selected color. Must be as big as _colors.
+	**/
+	void PaletteSnapshot::convert_colors( std::span< const sf::Color > _colors, std::span< uint16_t > _palette_indices ) const
+	{
+		if( m_nb_colors == 0 )
+		{
+			std::ranges::fill( _palette_indices, Invalid_Index );
+			return;
+		}
+
+		const Kernel kernel{ _get_used_kernel() };
+		const ClosestColorKernel find_closest_color{ get_kernel_function( kernel, m_distance ) };
+
+		// The scalar version doesn't need to go through the padding colors.
+		const size_t nb_palette_colors{ kernel == Kernel::Scalar ? m_nb_colors : m_reds.size() };
+		const size_t nb_colors{ std::min( _colors.size(), _palette_indices.size() ) };
+
+		// The colors are converted to the coordinates compared by the distance all at once before looking for their closest palette color.
+		std::vector< ImVec4 > coordinates( nb_colors );
+		ColorSpaces::get_coordinates( m_distance, _colors.first( nb_colors ), coordinates );
+
+		for( size_t color{ 0 }; color < nb_colors; ++color )
+		{
+			const uint32_t closest_color{ find_closest_color( m_reds.data(), m_greens.data(), m_blues.data(), nb_palette_colors, coordinates[ color ] ) };
+			_palette_indices[ color ] = m_palette_indices[ closest_color ];
+		}
+	}
+
+	/**
+	* @brief Find the closest snapshot colors of each of the given colors, sorted from the closest to the farthest. Colors at the same distance are sorted in palette order.
+	* @param [in]	_colors			The colors to rank the snapshot colors for.
+	* @param [in]	_nb_candidates	The number of closest colors to keep for each color. Can't be more than the number of colors in the snapshot.
+	* @param [out]	_candidates		The palette indices of the closest colors, _nb_candidates per color one after another. Must be as big as _colors times _nb_candidates.
+	**/
+	void PaletteSnapshot::rank_colors( std::span< const sf::Color > _colors, size_t _nb_candidates, std::span< uint16_t > _candidates ) const
+	{
+		const size_t nb_candidates{ std::min( _nb_candidates, m_nb_colors ) };
+
+		if( nb_candidates == 0 )
+			return;
+
+		const Kernel kernel{ _get_used_kernel() };
+		const DistancesKernel compute_distances{ get_distances_function( kernel, m_distance ) };
+
+		// The SIMD kernels also compute the distances to the padding colors, which are never ranked.
+		const size_t nb_palette_colors{ kernel == Kernel::Scalar ? m_nb_colors : m_reds.size() };
+		const size_t nb_colors{ std::min( _colors.size(), _candidates.size() / _nb_candidates ) };
+
+		std::vector< ImVec4 > coordinates( nb_colors );
+		ColorSpaces::get_coordinates( m_distance, _colors.first( nb_colors ), coordinates );
+
+		std::vector< float > distances( nb_palette_colors );
+		std::vector< uint32_t > closest_colors( nb_candidates );
+		std::vector< uint64_t > sort_buffer;
+
+		for( size_t color{ 0 }; color < nb_colors; ++color )
+		{
+			compute_distances( m_reds.data(), m_greens.data(), m_blues.data(), nb_palette_colors, coordinates[ color ], distances.data() );
+			find_smallest_distances( std::span{ distances }.first( m_nb_colors ), closest_colors, sort_buffer );
+
+			uint16_t* color_candidates{ _candidates.data() + color * _nb_candidates };
+
+			for( size_t candidate{ 0 }; candidate < nb_candidates; ++candidate )
+				color_candidates[ candidate ] = m_palette_indices[ closest_colors[ candidate ] ];
+		}
+	}
+
+	/**
+	* @brief Get the best kernel supported by the processor, which is used by convert_colors.
+	**/
+	PaletteSnapshot::Kernel PaletteSnapshot::get_kernel()
+	{
+		static const Kernel kernel{ detect_kernel() };
+		return kernel;
+	}
+
+
+	/**
+	* @brief Get the kernel convert_colors will use with the current colors and distance.
+	**/
+	PaletteSnapshot::Kernel PaletteSnapshot::_get_used_kernel() const
+	{
+		if( m_nb_colors < Min_SIMD_Colors || m_distance == ColorDistance::CIE2000 )
+			return Kernel::Scalar;
+
+		return get_kernel();
+	}
+} // namespace Pixeler
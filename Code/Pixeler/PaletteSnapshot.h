@@ -0,0 +1,109 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <SFML/Graphics/Color.hpp>
+
+#include "ColorPalette.h"
+
+
+namespace Pixeler
+{
+	/************************************************************************
+	* @brief Packed copy of the selected colors of a palette, one array per channel, used to convert a lot of colors at once.
+	* Each color is compared with several palette colors per instruction when the processor supports it (AVX2 or SSE4.1), with a scalar fallback otherwise.
+	* CIEDE2000 has no SIMD version and always uses the scalar one.
+	* Distances are computed exactly like ColorSpaces::get_distance and ties resolve to the first color in palette order, so results are identical to an exhaustive search.
+	************************************************************************/
+	class PaletteSnapshot
+	{
+	public:
+		static constexpr uint16_t Invalid_Index{ std::numeric_limits< uint16_t >::max() };
+
+		/************************************************************************
+		* @brief The instruction sets the conversion kernel can use, the best one supported by the processor being selected at runtime.
+		************************************************************************/
+		enum class Kernel : uint8_t
+		{
+			Scalar,
+			SSE41,
+			AVX2,
+		};
+
+		/**
+		* @brief Check if the snapshot has to be built again because the given palette or distance are not the ones used for the last build, or the colors or selection of the palette changed since then.
+		* @param [in] _palette		The palette to compare with the snapshot content.
+		* @param [in] _distance	The distance that will be used to compare the colors.
+		* @param [in] _all_colors	True if the snapshot contains all the colors of the palette, in which case their selection doesn't matter.
+		* @return True if the snapshot isn't up to date.
+		**/
+		bool needs_rebuild( const ColorPalette& _palette, ColorDistance _distance, bool _all_colors = false ) const;
+
+		/**
+		* @brief Copy the selected colors of the given palette.
+		* @param [in] _palette		The palette to use.
+		* @param [in] _distance	The distance that will be used to compare the colors. The snapshot contains the coordinates of the colors for this distance.
+		* @param [in] _all_colors	Copy all the colors of the palette, selected or not. Used to rank the palette colors with rank_colors.
+		**/
+		void build( const ColorPalette& _palette, ColorDistance _distance, bool _all_colors = false );
+
+		/**
+		* @brief Empty the snapshot, it will have to be built again before being used.
+		**/
+		void clear();
+
+		/**
+		* @brief Check if the last build has been made with the given palette.
+		* @param [in] _palette The palette to check.
+		* @return True if the snapshot can be used with this palette.
+		**/
+		bool is_built_for( const ColorPalette* _palette ) const { return _palette != nullptr && m_palette == _palette; }
+
+		/**
+		* @brief Get the distance used for the last build.
+		**/
+		ColorDistance get_distance() const { return m_distance; }
+
+		/**
+		* @brief Find the closest selected palette color of each of the given colors. Alpha is ignored.
+		* @param [in]	_colors				The colors to convert.
+		* @param [out]	_palette_indices	The index in the palette colors vector of the closest color to each color, Invalid_Index if there is no selected color. Must be as big as _colors.
+		**/
+		void convert_colors( std::span< const sf::Color > _colors, std::span< uint16_t > _palette_indices ) const;
+
+		/**
+		* @brief Find the closest snapshot colors of each of the given colors, sorted from the closest to the farthest. Colors at the same distance are sorted in palette order.
+		* @param [in]	_colors			The colors to rank the snapshot colors for.
+		* @param [in]	_nb_candidates	The number of closest colors to keep for each color. Can't be more than the number of colors in the snapshot.
+		* @param [out]	_candidates		The palette indices of the closest colors, _nb_candidates per color one after another. Must be as big as _colors times _nb_candidates.
+		**/
+		void rank_colors( std::span< const sf::Color > _colors, size_t _nb_candidates, std::span< uint16_t > _candidates ) const;
+
+		/**
+		* @brief Get the number of colors in the snapshot.
+		**/
+		size_t get_nb_colors() const { return m_nb_colors; }
+
+		/**
+		* @brief Get the best kernel supported by the processor, which is used by convert_colors.
+		**/
+		static Kernel get_kernel();
+
+	private:
+		/**
+		* @brief Get the kernel convert_colors will use with the current colors and distance.
+		**/
+		Kernel _get_used_kernel() const;
+
+		std::vector< float >		m_reds;						// Coordinates of the selected colors for the distance, padded to a multiple of the widest kernel with colors too far to ever be the closest.
+		std::vector< float >		m_greens;
+		std::vector< float >		m_blues;
+		std::vector< uint16_t >		m_palette_indices;			// The index of each selected color in the palette colors vector.
+		size_t						m_nb_colors{ 0 };			// The number of selected colors, without padding.
+		const ColorPalette*			m_palette{ nullptr };		// The palette used for the last build.
+		uint64_t					m_signature{ 0 };			// The signature of the palette at the time of the last build.
+		ColorDistance				m_distance{ ColorDistance::RGB };
+		bool						m_all_colors{ false };		// The snapshot contains all the colors of the palette instead of the selected ones.
+	};
+} // namespace Pixeler
@@ -1,6 +1,7 @@
 #include <filesystem>
 #include <algorithm>
 #include <limits>
+#include <tuple>
 #include <cctype>
 
 #include <FZN/Managers/FazonCore.h>
@@ -8,12 +9,18 @@
 #include <FZN/Tools/Math.h>
 #include <FZN/Tools/Tools.h>
 
+#include "ColorMetrics.h"
 #include "PalettesManager.h"
+#include "Pixeler.h"
 #include "Utils.h"
 
 
 namespace Pixeler
 {
+	static constexpr size_t Lookup_Table_Min_Colors{ 200000 };		// Number of distinct colors to convert from which building the lookup table is faster than searching the palette for each of them.
+	static constexpr size_t Min_Colors_Per_Task{ 4096 };			// Below this number of colors to convert, starting another thread costs more than it saves.
+	static constexpr size_t KD_Tree_Min_Colors{ 768 };				// Number of selected colors from which searching the k-d tree is faster than comparing a color with the whole palette snapshot.
+
 	PalettesManager::PalettesManager():
 		m_fzn_palettes_path( g_pFZN_Core->GetDataPath( "XMLFiles/Palettes" ) ),
 		m_app_palettes_path( g_pFZN_Core->GetSaveFolderPath() + "/Palettes" )
@@ -51,46 +58,223 @@ namespace Pixeler
 	}
 
 	/**
-	* @brief Convert the given color to a new one according to the selected palette.
-	* @param [in] _color The color to convert.
-	* @return A pair containing the converted color and a pointer to the converted color infos in the palette.
-	* If no palette is selected, the given color will be returned
+	* @brief Convert the distinct colors gathered in the given result according to the selected palette.
+	* The first conversion searches the selected colors. Once the selection changes, the palette colors are ranked for each distinct color, so the following selections only pick the first selected candidate of each color.
+	* The palettes are not modified, so this can be called from another thread as long as the palette isn't edited meanwhile and prepare_conversion has been called before.
+	* @param [in,out] _result The result to fill. Its colors must have been gathered.
 	**/
-	std::pair< sf::Color, const ColorInfos* > PalettesManager::convert_color( const sf::Color& _color ) const
+	void PalettesManager::convert( ConversionResult& _result ) const
 	{
-		auto get_distance = []( const ImColor& _color_a, const ImColor& _color_b )
+		if( m_selected_palette == nullptr )
+			return;
+
+		const auto start_time{ std::chrono::steady_clock::now() };
+		const ColorDistance distance{ _get_color_distance() };
+		const std::vector< sf::Color >& distinct_colors{ _result.get_distinct_colors() };
+		const size_t nb_colors{ distinct_colors.size() };
+
+		std::shared_ptr< const ColorCandidates > candidates{ _result.get_candidates() };
+
+		if( candidates == nullptr || candidates->get_nb_colors() != nb_colors || candidates->is_built_for( *m_selected_palette, distance ) == false )
 		{
-			return fzn::Math::Square( _color_b.Value.x - _color_a.Value.x ) + fzn::Math::Square( _color_b.Value.y - _color_a.Value.y ) + fzn::Math::Square( _color_b.Value.z - _color_a.Value.z );
-		};
-		
+			candidates = nullptr;
+
+			// Ranking every palette color for every distinct color costs more than searching the selected ones, it only pays off once the selection changes.
+			if( _needs_candidates( _result, distance ) && m_palette_colors_snapshot.is_built_for( m_selected_palette ) && m_palette_colors_snapshot.get_distance() == distance )
+			{
+				auto new_candidates{ std::make_shared< ColorCandidates >() };
+				new_candidates->build( m_palette_colors_snapshot, *m_selected_palette, distinct_colors );
+				candidates = std::move( new_candidates );
+			}
+		}
+
+		std::vector< uint16_t > palette_indices( nb_colors, ColorCandidates::Unresolved_Index );
+		std::vector< int > color_counts( m_selected_palette->m_colors.size() );
+
+		if( candidates != nullptr )
+		{
+			std::vector< uint8_t > selection( m_selected_palette->m_colors.size() );
+			std::ranges::transform( m_selected_palette->m_colors, selection.begin(), []( const ColorInfos& _color ) -> uint8_t { return _color.m_selected ? 1 : 0; } );
+
+			Utils::parallel_for( nb_colors, Utils::get_nb_tasks( nb_colors, Min_Colors_Per_Task ), [&]( size_t /*_task*/, size_t _first_color, size_t _last_color )
+			{
+				for( size_t color{ _first_color }; color < _last_color; ++color )
+					palette_indices[ color ] = candidates->find_color_index( color, selection );
+			} );
+		}
+
+		// The colors having none of their candidates selected are searched among the selected colors.
+		std::vector< size_t > unresolved_colors;
+
+		for( size_t color{ 0 }; color < nb_colors; ++color )
+		{
+			if( palette_indices[ color ] == ColorCandidates::Unresolved_Index )
+				unresolved_colors.push_back( color );
+		}
+
+		if( unresolved_colors.empty() == false )
+		{
+			std::vector< sf::Color > colors( unresolved_colors.size() );
+			std::vector< uint16_t > unresolved_indices( unresolved_colors.size() );
+
+			std::ranges::transform( unresolved_colors, colors.begin(), [&distinct_colors]( size_t _color ) { return distinct_colors[ _color ]; } );
+			_find_palette_indices( colors, unresolved_indices, distance );
+
+			for( size_t color{ 0 }; color < unresolved_colors.size(); ++color )
+				palette_indices[ unresolved_colors[ color ] ] = unresolved_indices[ color ];
+		}
+
+		_count_pixels( palette_indices, _result.get_distinct_colors_pixels(), color_counts );
+
+		_result.set_palette_indices( *m_selected_palette, distance, std::move( candidates ), palette_indices, std::move( color_counts ), std::chrono::steady_clock::now() - start_time );
+	}
+
+	/**
+	* @brief Check if the selected palette has been modified since it was used to convert the given result, either its colors or their selection, or if the color distance changed since.
+	* When only the selection changed, the palette candidates of the result are still valid and converting it again is almost instant.
+	* @param [in] _result The result to check.
+	* @return True if the result has been converted with the selected palette, but not with its current state or not with the current color distance.
+	**/
+	bool PalettesManager::is_conversion_outdated( const ConversionResult& _result ) const
+	{
+		if( m_selected_palette == nullptr || _result.is_converted() == false || _result.get_palette_name() != m_selected_palette->m_name )
+			return false;
+
+		return _result.get_distance() != _get_color_distance() || _result.get_selection_signature() != m_selected_palette->compute_selection_signature();
+	}
+
+	/**
+	* @brief Prepare the search structures used to convert colors with the selected palette, building them again if the palette, its colors or their selection changed since the last build.
+	* The lookup table is only worth its build time when a lot of colors are searched, otherwise the palette snapshot is used.
+	* With the RGB distance, the k-d tree replaces the snapshot from 768 selected colors on, below that the SIMD snapshot is faster.
+	* @param [in] _result The result that will be converted. Its colors must have been gathered.
+	**/
+	void PalettesManager::prepare_conversion( const ConversionResult& _result )
+	{
 		if( m_selected_palette == nullptr )
-			return { _color, nullptr };
-		
-		ImColor converted_color{ _color };
-		ColorInfos* smallest_distance_color{ nullptr };
-		float smallest_distance{ Flt_Max };
-		float current_distance{ Flt_Max };
+		{
+			m_lookup_table.clear();
+			m_color_tree.clear();
+			m_palette_snapshot.clear();
+			m_palette_colors_snapshot.clear();
+			return;
+		}
 
-		for( auto& color : m_selected_palette->m_colors )
+		const ColorDistance distance{ _get_color_distance() };
+
+		if( m_palette_snapshot.needs_rebuild( *m_selected_palette, distance ) )
+			m_palette_snapshot.build( *m_selected_palette, distance );
+
+		if( m_palette_colors_snapshot.needs_rebuild( *m_selected_palette, distance, true ) )
+			m_palette_colors_snapshot.build( *m_selected_palette, distance, true );
+
+		// The lookup table and the k-d tree are built from RGB distances, they can't be used with other distances.
+		if( distance != ColorDistance::RGB )
 		{
-			if( color.m_selected == false )
-				continue;
+			m_lookup_table.clear();
+			m_color_tree.clear();
+			return;
+		}
+
+		m_lookup_table.set_exact_refinement( g_pixeler->get_options().get_options_datas().m_exact_color_matching );
+
+		// When the candidates of the colors are ranked, or about to be, only a few colors are searched among the selected ones, the table isn't worth building.
+		const bool candidates_ready{ ( _result.get_candidates() != nullptr && _result.get_candidates()->is_built_for( *m_selected_palette, distance ) ) || _needs_candidates( _result, distance ) };
+
+		// An up to date table is kept whatever the number of colors, but an outdated one must not be used.
+		if( m_lookup_table.needs_rebuild( *m_selected_palette ) )
+		{
+			if( candidates_ready == false && _result.get_distinct_colors().size() >= Lookup_Table_Min_Colors )
+				m_lookup_table.build( *m_selected_palette );
+			else
+				m_lookup_table.clear();
+		}
+
+		// The SIMD snapshot compares several palette colors at once, the tree only wins when so many colors are selected that it skips most of them.
+		// It isn't needed either when the lookup table answers every color.
+		if( m_lookup_table.is_built_for( m_selected_palette ) || m_palette_snapshot.get_nb_colors() < KD_Tree_Min_Colors )
+			m_color_tree.clear();
+		else if( m_color_tree.needs_rebuild( *m_selected_palette ) )
+			m_color_tree.build( *m_selected_palette );
+	}
+
+	/**
+	* @brief Check that splitting the conversion between several threads gives the same result as a single thread, for each palette and each distance.
+	* A fixed image is gathered, converted and its pixels counted once in a single band and once in several, each difference is logged.
+	* The application doesn't run it, it is only done when started with the --check-conversion argument.
+	* @return True if both ways gave the same distinct colors, pixel colors, palette indices and color counts.
+	**/
+	bool PalettesManager::check_parallel_conversion()
+	{
+		static constexpr uint32_t image_width{ 96 };
+		static constexpr uint32_t image_height{ 64 };
+		static constexpr size_t nb_bands{ 5 };
 
-			current_distance = get_distance( converted_color, color.m_color );
-			if( current_distance < smallest_distance )
+		// The colors repeat from one band to another, so merging the bands has to keep the order of their first pixel. Some pixels are transparent.
+		std::vector< sf::Color > pixels;
+		pixels.reserve( image_width * image_height );
+
+		for( uint32_t y{ 0 }; y < image_height; ++y )
+		{
+			for( uint32_t x{ 0 }; x < image_width; ++x )
 			{
-				smallest_distance = current_distance;
-				smallest_distance_color = &color;
+				const sf::Uint8 alpha{ static_cast< sf::Uint8 >( ( x + y ) % 13 == 0 ? 0 : 255 ) };
+				pixels.emplace_back( static_cast< sf::Uint8 >( ( x * 37 + y * 11 ) & 0xF0 ), static_cast< sf::Uint8 >( ( x * y ) & 0xFC ), static_cast< sf::Uint8 >( ( ( x ^ y ) * 4 ) & 0xFF ), alpha );
 			}
 		}
 
-		if( smallest_distance_color != nullptr )
+		ConversionResult single_band_result;
+		ConversionResult multi_band_result;
+		single_band_result.gather_colors( pixels, image_width, 1 );
+		multi_band_result.gather_colors( pixels, image_width, nb_bands );
+
+		bool same_results{ single_band_result.get_distinct_colors() == multi_band_result.get_distinct_colors()
+			&& single_band_result.get_distinct_colors_pixels() == multi_band_result.get_distinct_colors_pixels()
+			&& std::ranges::equal( single_band_result.get_pixels_distinct_colors(), multi_band_result.get_pixels_distinct_colors() ) };
+
+		for( size_t color{ 0 }; same_results && color < single_band_result.get_distinct_colors().size(); ++color )
+			same_results = std::ranges::equal( single_band_result.get_color_pixels( color ), multi_band_result.get_color_pixels( color ) );
+
+		if( same_results == false )
+		{
+			FZN_COLOR_LOG( fzn::DBG_MSG_COL_RED, "Failure : gathering the colors in %zu bands doesn't give the same colors as in a single one", nb_bands );
+			return false;
+		}
+
+		const std::vector< sf::Color >& colors{ single_band_result.get_distinct_colors() };
+		const std::vector< int >& nb_pixels{ single_band_result.get_distinct_colors_pixels() };
+		ColorPalette* selected_palette{ m_selected_palette };
+		size_t nb_failures{ 0 };
+
+		for( ColorPalette& palette : m_palettes )
 		{
-			++smallest_distance_color->m_count;
-			return { Utils::to_sf_color( smallest_distance_color->m_color ), smallest_distance_color };
+			m_selected_palette = &palette;
+			prepare_conversion( single_band_result );
+
+			for( int distance{ 0 }; distance < static_cast< int >( ColorDistance::COUNT ); ++distance )
+			{
+				std::vector< uint16_t > single_band_indices( colors.size() );
+				std::vector< uint16_t > multi_band_indices( colors.size() );
+				std::vector< int > single_band_counts( palette.m_colors.size() );
+				std::vector< int > multi_band_counts( palette.m_colors.size() );
+
+				_find_palette_indices( colors, single_band_indices, static_cast< ColorDistance >( distance ), 1 );
+				_find_palette_indices( colors, multi_band_indices, static_cast< ColorDistance >( distance ), nb_bands );
+				_count_pixels( single_band_indices, nb_pixels, single_band_counts, 1 );
+				_count_pixels( multi_band_indices, nb_pixels, multi_band_counts, nb_bands );
+
+				if( single_band_indices == multi_band_indices && single_band_counts == multi_band_counts )
+					continue;
+
+				FZN_COLOR_LOG( fzn::DBG_MSG_COL_RED, "Failure : converting on %zu threads doesn't give the same colors as on a single one (%s, %s distance)", nb_bands, palette.m_name.c_str(), ColorDistance_Names[ distance ] );
+				++nb_failures;
+			}
 		}
 
-		return { _color, nullptr };
+		m_selected_palette = selected_palette;
+
+		FZN_LOG( "Checked the conversion of %zu colors with %zu palettes on one and %zu threads : %zu failure(s).", colors.size(), m_palettes.size(), nb_bands, nb_failures );
+		return nb_failures == 0;
 	}
 
 	/**
@@ -130,27 +314,38 @@ namespace Pixeler
 	}
 
 	/**
-	* @brief Set all colors counts of the current palette to 0. Called when beginning a new image convertion.
-	* @param _all_palettes True if the color counts of all the palettes are reset. Juste the selected one otherwise.
+	* @brief Replace the conversion result displayed in the colors list. The result is swapped atomically, so it can be given by any thread.
+	* @param [in] _result The new result, nullptr to remove the current one.
 	**/
-	void PalettesManager::reset_color_counts( bool _all_palettes )
+	void PalettesManager::set_conversion_result( std::shared_ptr< const ConversionResult > _result )
 	{
-		if( _all_palettes )
-		{
-			for( ColorPalette& palette : m_palettes )
-			{
-				for( auto& color : palette.m_colors )
-					color.m_count = 0;
-			}
+		m_conversion_result.store( std::move( _result ) );
+	}
 
-			return;
-		}
+	/**
+	* @brief Get the number of pixels converted to the given color in the current conversion result.
+	* @param [in] _color The color to look for.
+	* @return The number of pixels using the color, 0 if it wasn't used or isn't part of the converted palette, -1 if there is no conversion.
+	**/
+	int PalettesManager::get_color_count( const ColorInfos& _color ) const
+	{
+		const std::shared_ptr< const ConversionResult > result{ m_conversion_result.load() };
 
-		if( m_selected_palette == nullptr )
-			return;
+		if( result == nullptr || result->is_converted() == false )
+			return -1;
 
-		for( auto& color : m_selected_palette->m_colors )
-			color.m_count = 0;
+		const ColorPalette* palette{ get_palette( result->get_palette_name() ) };
+
+		if( palette == nullptr || palette->m_colors.empty() )
+			return 0;
+
+		// The color is identified by its address, copies of palette colors (like the edited color) don't have a count.
+		const ColorInfos* first_color{ palette->m_colors.data() };
+
+		if( &_color < first_color || &_color >= first_color + palette->m_colors.size() )
+			return 0;
+
+		return result->get_color_count( static_cast< uint16_t >( &_color - first_color ) );
 	}
 
 	/**
@@ -162,8 +357,9 @@ namespace Pixeler
 		if( m_selected_palette == nullptr )
 			return false;
 
-		// When doing a convertion, we set all color counts to 0 instead of -1, so if the first color available has a count of at least 0, a convertion occured.
-		return m_selected_palette->m_colors.empty() == false && m_selected_palette->m_colors.begin()->m_count >= 0;
+		const std::shared_ptr< const ConversionResult > result{ m_conversion_result.load() };
+
+		return result != nullptr && result->is_converted();
 	}
 
 	/**
@@ -175,6 +371,18 @@ namespace Pixeler
 		return m_selected_palette;
 	}
 
+	/**
+	* @brief Look for a palette by name. The conversions keep the name of their palette, as its address changes when palettes are added or removed.
+	* @param [in] _palette The name of the palette to find.
+	* @return A pointer to the palette if found, nullptr otherwise. Only valid until the palette list changes.
+	**/
+	const ColorPalette* PalettesManager::get_palette( std::string_view _palette ) const
+	{
+		auto it_palette = std::ranges::find( m_palettes, _palette, &ColorPalette::m_name );
+
+		return it_palette != m_palettes.end() ? &( *it_palette ) : nullptr;
+	}
+
 	/**
 	* @brief Select a new palette to use. This selects the default preset and compute the IDs column size.
 	* @param _palette The new palette.
@@ -294,6 +502,7 @@ namespace Pixeler
 		{
 			color_infos.m_color_id = { fzn::Tools::XMLStringAttribute( color_settings, "name" ), color_settings->IntAttribute( "id", -1 ) };
 			color_infos.m_color = fzn::Tools::GetImColorFromString( fzn::Tools::XMLStringAttribute( color_settings, "rgb" ) );
+			color_infos.update_color_spaces();
 
 			if( color_infos.m_color_id.is_valid() == false )
 			{
@@ -663,6 +872,67 @@ namespace Pixeler
 	{
 		m_edited_color = ColorInfos{};
 		m_color_to_edit = nullptr;
+		m_edited_color_preview = EditedColorPreview{};
+	}
+
+	/**
+	* @brief Display the edited color on the canvas as if it was already applied to the palette. Only the pixels whose palette color changes are updated.
+	**/
+	void PalettesManager::_preview_edited_color()
+	{
+		if( m_color_to_edit == nullptr || m_selected_palette == nullptr || m_color_to_edit->m_selected == false )
+			return;
+
+		EditedColorPreview& preview{ m_edited_color_preview };
+
+		if( preview.m_result == nullptr )
+		{
+			// The preview starts from the displayed conversion, which has to be up to date with the palette for its distances to be right.
+			const std::shared_ptr< const ConversionResult > base_result{ get_conversion_result() };
+
+			if( base_result == nullptr || base_result->is_converted() == false || is_conversion_outdated( *base_result ) || base_result->get_palette_name() != m_selected_palette->m_name )
+				return;
+
+			preview.m_base_result = base_result;
+			preview.m_result = std::make_shared< ConversionResult >( *base_result );
+			preview.m_coordinates.resize( base_result->get_distinct_colors().size() );
+			preview.m_changed_colors.assign( base_result->get_distinct_colors().size(), 0 );
+			ColorSpaces::get_coordinates( base_result->get_distance(), base_result->get_distinct_colors(), preview.m_coordinates );
+
+			set_conversion_result( preview.m_result );
+		}
+
+		const uint16_t palette_index{ static_cast< uint16_t >( m_color_to_edit - m_selected_palette->m_colors.data() ) };
+		const std::vector< uint32_t > changed_colors{ _convert_edited_color( *preview.m_result, palette_index, m_edited_color, preview.m_coordinates ) };
+
+		for( const uint32_t color : changed_colors )
+			preview.m_changed_colors[ color ] = 1;
+
+		g_pixeler->get_canvas_manager().apply_edited_color( *preview.m_result, changed_colors, palette_index, m_edited_color.m_color );
+	}
+
+	/**
+	* @brief Give back their palette colors to the pixels modified by the preview of the edited color.
+	**/
+	void PalettesManager::_cancel_edited_color_preview()
+	{
+		const EditedColorPreview& preview{ m_edited_color_preview };
+
+		if( preview.m_result == nullptr || m_color_to_edit == nullptr )
+			return;
+
+		std::vector< uint32_t > changed_colors;
+
+		for( uint32_t color{ 0 }; color < preview.m_changed_colors.size(); ++color )
+		{
+			if( preview.m_changed_colors[ color ] != 0 )
+				changed_colors.push_back( color );
+		}
+
+		const uint16_t palette_index{ static_cast< uint16_t >( m_color_to_edit - m_selected_palette->m_colors.data() ) };
+
+		set_conversion_result( preview.m_base_result );
+		g_pixeler->get_canvas_manager().apply_edited_color( *preview.m_base_result, changed_colors, palette_index, m_color_to_edit->m_color );
 	}
 
 	/**
@@ -798,4 +1068,284 @@ namespace Pixeler
 		// If no ID matched or the given color doesn't use it, we look for its name in the filter.
 		return fzn::Tools::match_filter( m_color_filter, _color.m_color_id.m_name );
 	}
+
+	/**
+	* @brief Find the closest selected color to the given one by comparing it with all the colors of the current palette.
+	* @param [in] _color The color to look for.
+	* @return A pointer to the closest color, nullptr if there is no selected color.
+	**/
+	ColorInfos* PalettesManager::_find_closest_color( const sf::Color& _color, ColorDistance _distance ) const
+	{
+		if( m_selected_palette == nullptr )
+			return nullptr;
+
+		const ImVec4 converted_color{ ColorSpaces::get_coordinates( _distance, _color ) };
+
+		return Metric::dispatch( _distance, [&]< typename DistanceMetric >( DistanceMetric ) -> ColorInfos*
+		{
+			ColorInfos* smallest_distance_color{ nullptr };
+			float smallest_distance{ Flt_Max };
+			float current_distance{ Flt_Max };
+
+			for( auto& color : m_selected_palette->m_colors )
+			{
+				if( color.m_selected == false )
+					continue;
+
+				if constexpr( DistanceMetric::Use_Lower_Bound )
+				{
+					if( DistanceMetric::get_lower_bound( converted_color, color.get_coordinates( _distance ) ) >= smallest_distance )
+						continue;
+				}
+
+				current_distance = DistanceMetric::get_distance( converted_color, color.get_coordinates( _distance ) );
+				if( current_distance < smallest_distance )
+				{
+					smallest_distance = current_distance;
+					smallest_distance_color = &color;
+				}
+			}
+
+			return smallest_distance_color;
+		} );
+	}
+
+	/**
+	* @brief Find the closest selected color to the given one with the fastest structure available for the given distance. Doesn't modify the palette so it can be called from several threads.
+	* @param [in] _color		The color to look for.
+	* @param [in] _distance	The distance used to compare the colors.
+	* @return The index of the closest color in the palette colors vector, Invalid_Index if there is no selected color.
+	**/
+	uint16_t PalettesManager::_find_color_index( const sf::Color& _color, ColorDistance _distance ) const
+	{
+		if( m_selected_palette == nullptr )
+			return PaletteSnapshot::Invalid_Index;
+
+		// The lookup table and the k-d tree only handle the RGB distance.
+		if( _distance == ColorDistance::RGB )
+		{
+			if( m_lookup_table.is_built_for( m_selected_palette ) )
+				return m_lookup_table.find_color_index( _color );
+
+			if( m_color_tree.is_built_for( m_selected_palette ) )
+				return m_color_tree.find_color_index( _color );
+		}
+
+		const ColorInfos* closest_color{ _find_closest_color( _color, _distance ) };
+
+		if( closest_color == nullptr )
+			return PaletteSnapshot::Invalid_Index;
+
+		return static_cast< uint16_t >( closest_color - m_selected_palette->m_colors.data() );
+	}
+
+	/**
+	* @brief Find the closest selected color of each of the given colors with the fastest structure available, splitting big lists between several threads.
+	* @param [in]	_colors				The colors to convert.
+	* @param [out]	_palette_indices	The index in the palette colors vector of the closest color to each color, Invalid_Index if no color is selected. Must be as big as _colors.
+	* @param [in]	_distance			The distance used to compare the colors.
+	* @param [in]	_nb_tasks			The number of threads the colors are split between, 0 to choose it from the number of colors.
+	**/
+	void PalettesManager::_find_palette_indices( std::span< const sf::Color > _colors, std::span< uint16_t > _palette_indices, ColorDistance _distance, size_t _nb_tasks /*= 0*/ ) const
+	{
+		const size_t nb_colors{ std::min( _colors.size(), _palette_indices.size() ) };
+		const bool snapshot_ready{ m_palette_snapshot.is_built_for( m_selected_palette ) && m_palette_snapshot.get_distance() == _distance };
+
+		// A lookup table is faster than the snapshot, and so is the k-d tree, which is only built for big selections of colors.
+		// _find_color_index uses either of them, and also handles the case where nothing has been prepared for this palette.
+		const bool rgb_structure_ready{ m_lookup_table.is_built_for( m_selected_palette ) || m_color_tree.is_built_for( m_selected_palette ) };
+		const bool use_snapshot{ snapshot_ready && ( _distance != ColorDistance::RGB || rgb_structure_ready == false ) };
+
+		// The search structures are only read here, and each task writes in its own range of indices.
+		Utils::parallel_for( nb_colors, _nb_tasks > 0 ? _nb_tasks : Utils::get_nb_tasks( nb_colors, Min_Colors_Per_Task ), [&]( size_t /*_task*/, size_t _first_color, size_t _last_color )
+		{
+			if( use_snapshot )
+				m_palette_snapshot.convert_colors( _colors.subspan( _first_color, _last_color - _first_color ), _palette_indices.subspan( _first_color, _last_color - _first_color ) );
+			else
+			{
+				for( size_t color{ _first_color }; color < _last_color; ++color )
+					_palette_indices[ color ] = _find_color_index( _colors[ color ], _distance );
+			}
+		} );
+	}
+
+	/**
+	* @brief Check if the palette candidates of the distinct colors of a result have to be ranked before converting it.
+	* They are only ranked once the selection changes: the result has already been converted with the same palette colors and distance, but isn't up to date anymore.
+	* The first conversion of an image searches the selected colors with the lookup table, the k-d tree or the snapshot instead.
+	* @param [in] _result		The result that will be converted.
+	* @param [in] _distance	The distance used for the conversion.
+	**/
+	bool PalettesManager::_needs_candidates( const ConversionResult& _result, ColorDistance _distance ) const
+	{
+		if( m_selected_palette == nullptr || _result.is_converted() == false || _result.get_palette_name() != m_selected_palette->m_name || _result.get_distance() != _distance )
+			return false;
+
+		if( _result.get_candidates() != nullptr && _result.get_candidates()->is_built_for( *m_selected_palette, _distance ) )
+			return false;
+
+		return _result.get_colors_signature() == m_selected_palette->compute_colors_signature();
+	}
+
+	/**
+	* @brief Count the number of pixels converted to each palette color. Big lists are split between several threads, each one counting on its own before all the counts are added together.
+	* @param [in]	_palette_indices	The index in the palette colors vector of each converted color.
+	* @param [in]	_nb_pixels			The number of pixels having each converted color. Must be as big as _palette_indices.
+	* @param [out]	_color_counts		The number of pixels converted to each color of the palette.
+	* @param [in]	_nb_tasks			The number of threads the colors are split between, 0 to choose it from the number of colors.
+	**/
+	void PalettesManager::_count_pixels( std::span< const uint16_t > _palette_indices, std::span< const int > _nb_pixels, std::span< int > _color_counts, size_t _nb_tasks /*= 0*/ ) const
+	{
+		const size_t nb_colors{ std::min( _palette_indices.size(), _nb_pixels.size() ) };
+		const size_t nb_palette_colors{ _color_counts.size() };
+		const size_t nb_tasks{ _nb_tasks > 0 ? _nb_tasks : Utils::get_nb_tasks( nb_colors, Min_Colors_Per_Task ) };
+		std::vector< std::vector< int > > tasks_counts( nb_tasks, std::vector< int >( nb_palette_colors, 0 ) );
+
+		Utils::parallel_for( nb_colors, nb_tasks, [&]( size_t _task, size_t _first_color, size_t _last_color )
+		{
+			std::vector< int >& task_counts{ tasks_counts[ _task ] };
+
+			for( size_t color{ _first_color }; color < _last_color; ++color )
+			{
+				if( _palette_indices[ color ] < nb_palette_colors )
+					task_counts[ _palette_indices[ color ] ] += _nb_pixels[ color ];
+			}
+		} );
+
+		std::ranges::fill( _color_counts, 0 );
+
+		for( const std::vector< int >& task_counts : tasks_counts )
+		{
+			for( size_t palette_color{ 0 }; palette_color < nb_palette_colors; ++palette_color )
+				_color_counts[ palette_color ] += task_counts[ palette_color ];
+		}
+	}
+
+	/**
+	* @brief Update a conversion after one of its palette colors changed, by only looking for a new palette color for the distinct colors that were using it or that are closer to its new value.
+	* @param [in,out]	_result			The result to update. It must have been converted with the current selection of the selected palette.
+	* @param [in]		_palette_index	The index of the edited color in the palette colors vector. It must be selected.
+	* @param [in]		_new_color		The new value of the edited color.
+	* @param [in]		_coordinates	The coordinates of the distinct colors of the result, for the distance of its conversion.
+	* @return The distinct colors whose pixels have to be displayed again: the ones given another palette color and the ones using the edited color.
+	**/
+	std::vector< uint32_t > PalettesManager::_convert_edited_color( ConversionResult& _result, uint16_t _palette_index, const ColorInfos& _new_color, std::span< const ImVec4 > _coordinates ) const
+	{
+		const ColorPalette* palette{ get_palette( _result.get_palette_name() ) };
+
+		if( palette == nullptr || _palette_index >= palette->m_colors.size() )
+			return {};
+
+		const ColorDistance distance{ _result.get_distance() };
+		const ImVec4& new_coordinates{ _new_color.get_coordinates( distance ) };
+		const std::vector< uint16_t >& palette_indices{ _result.get_colors_palette_indices() };
+		const std::vector< float >& distances{ _result.get_colors_distances() };
+		const size_t nb_colors{ std::min( { palette_indices.size(), distances.size(), _coordinates.size() } ) };
+
+		// The candidates give the closest of the other selected colors, which didn't move, to the colors that were using the edited one.
+		const ColorCandidates* candidates{ _result.get_candidates() != nullptr && _result.get_candidates()->is_built_for( *palette, distance ) ? _result.get_candidates().get() : nullptr };
+		std::vector< uint8_t > other_colors_selection( palette->m_colors.size() );
+		std::ranges::transform( palette->m_colors, other_colors_selection.begin(), []( const ColorInfos& _color ) -> uint8_t { return _color.m_selected ? 1 : 0; } );
+		other_colors_selection[ _palette_index ] = 0;
+
+		/************************************************************************
+		* @brief The distinct colors of a range whose pixels have to be displayed again, and their new palette colors.
+		************************************************************************/
+		struct ChangedColors
+		{
+			std::vector< uint32_t >	m_colors;
+			std::vector< uint16_t >	m_palette_indices;
+			std::vector< float >	m_distances;
+		};
+
+		const size_t nb_tasks{ Utils::get_nb_tasks( nb_colors, Min_Colors_Per_Task ) };
+		std::vector< ChangedColors > tasks_changes( nb_tasks );
+
+		Metric::dispatch( distance, [&]< typename DistanceMetric >( DistanceMetric )
+		{
+			auto find_closest_other_color = [&]( size_t _color ) -> std::pair< uint16_t, float >
+			{
+				uint16_t closest_color{ candidates != nullptr ? candidates->find_color_index( _color, other_colors_selection ) : ColorCandidates::Unresolved_Index };
+
+				if( closest_color == ColorCandidates::Invalid_Index )
+					return { closest_color, Flt_Max };
+
+				if( closest_color != ColorCandidates::Unresolved_Index )
+					return { closest_color, DistanceMetric::get_distance( _coordinates[ _color ], palette->m_colors[ closest_color ].get_coordinates( distance ) ) };
+
+				std::pair< uint16_t, float > closest{ ColorCandidates::Invalid_Index, Flt_Max };
+
+				for( uint16_t palette_color{ 0 }; palette_color < palette->m_colors.size(); ++palette_color )
+				{
+					if( other_colors_selection[ palette_color ] == 0 )
+						continue;
+
+					const ImVec4& palette_coordinates{ palette->m_colors[ palette_color ].get_coordinates( distance ) };
+
+					if constexpr( DistanceMetric::Use_Lower_Bound )
+					{
+						if( DistanceMetric::get_lower_bound( _coordinates[ _color ], palette_coordinates ) >= closest.second )
+							continue;
+					}
+
+					const float color_distance{ DistanceMetric::get_distance( _coordinates[ _color ], palette_coordinates ) };
+
+					if( color_distance < closest.second )
+						closest = { palette_color, color_distance };
+				}
+
+				return closest;
+			};
+
+			// Ties are given to the lowest palette index, like the full conversion does.
+			Utils::parallel_for( nb_colors, nb_tasks, [&]( size_t _task, size_t _first_color, size_t _last_color )
+			{
+				ChangedColors& changes{ tasks_changes[ _task ] };
+
+				for( size_t color{ _first_color }; color < _last_color; ++color )
+				{
+					const float new_distance{ DistanceMetric::get_distance( _coordinates[ color ], new_coordinates ) };
+					uint16_t palette_index{ palette_indices[ color ] };
+					float color_distance{ distances[ color ] };
+
+					if( palette_index == _palette_index )
+					{
+						std::tie( palette_index, color_distance ) = find_closest_other_color( color );
+
+						if( new_distance < color_distance || ( new_distance == color_distance && _palette_index < palette_index ) )
+							std::tie( palette_index, color_distance ) = std::pair{ _palette_index, new_distance };
+					}
+					else if( new_distance < color_distance || ( new_distance == color_distance && _palette_index < palette_index ) )
+						std::tie( palette_index, color_distance ) = std::pair{ _palette_index, new_distance };
+					else
+						continue;
+
+					changes.m_colors.push_back( static_cast< uint32_t >( color ) );
+					changes.m_palette_indices.push_back( palette_index );
+					changes.m_distances.push_back( color_distance );
+				}
+			} );
+		} );
+
+		ChangedColors changed_colors;
+
+		for( const ChangedColors& task_changes : tasks_changes )
+		{
+			changed_colors.m_colors.insert( changed_colors.m_colors.end(), task_changes.m_colors.begin(), task_changes.m_colors.end() );
+			changed_colors.m_palette_indices.insert( changed_colors.m_palette_indices.end(), task_changes.m_palette_indices.begin(), task_changes.m_palette_indices.end() );
+			changed_colors.m_distances.insert( changed_colors.m_distances.end(), task_changes.m_distances.begin(), task_changes.m_distances.end() );
+		}
+
+		_result.reassign_colors( changed_colors.m_colors, changed_colors.m_palette_indices, changed_colors.m_distances );
+
+		return changed_colors.m_colors;
+	}
+
+	/**
+	* @brief Get the distance chosen in the options to compare colors.
+	**/
+	ColorDistance PalettesManager::_get_color_distance() const
+	{
+		return g_pixeler->get_options().get_options_datas().m_color_distance;
+	}
 } // namespace Pixeler
\ No newline at end of file
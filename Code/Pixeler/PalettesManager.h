@@ -1,4 +1,7 @@
 #pragma once
+#include <atomic>
+#include <memory>
+#include <span>
 #include <string>
 #include <unordered_map>
 
@@ -6,6 +9,10 @@
 
 #include "Defines.h"
 #include "ColorPalette.h"
+#include "ConversionResult.h"
+#include "PaletteKDTree.h"
+#include "PaletteLookupTable.h"
+#include "PaletteSnapshot.h"
 
 
 namespace tinyxml2
@@ -31,12 +38,36 @@ namespace Pixeler
 		void update();
 
 		/**
-		* @brief Convert the given color to a new one according to the selected palette.
-		* @param [in] _color The color to convert.
-		* @return A pair containing the converted color and a pointer to the converted color infos in the palette.
-		* If no palette is selected, the given color will be returned
+		* @brief Convert the distinct colors gathered in the given result according to the selected palette.
+		* The first conversion searches the selected colors. Once the selection changes, the palette colors are ranked for each distinct color, so the following selections only pick the first selected candidate of each color.
+		* The palettes are not modified, so this can be called from another thread as long as the palette isn't edited meanwhile and prepare_conversion has been called before.
+		* @param [in,out] _result The result to fill. Its colors must have been gathered.
 		**/
-		std::pair< sf::Color, const ColorInfos* > convert_color( const sf::Color& _color ) const;
+		void convert( ConversionResult& _result ) const;
+
+		/**
+		* @brief Check if the selected palette has been modified since it was used to convert the given result, either its colors or their selection, or if the color distance changed since.
+		* When only the selection changed, the palette candidates of the result are still valid and converting it again is almost instant.
+		* @param [in] _result The result to check.
+		* @return True if the result has been converted with the selected palette, but not with its current state or not with the current color distance.
+		**/
+		bool is_conversion_outdated( const ConversionResult& _result ) const;
+
+		/**
+		* @brief Prepare the search structures used to convert colors with the selected palette, building them again if the palette, its colors or their selection changed since the last build.
+		* The lookup table is only worth its build time when a lot of colors are searched, otherwise the palette snapshot is used.
+		* With the RGB distance, the k-d tree replaces the snapshot from 768 selected colors on, below that the SIMD snapshot is faster.
+		* @param [in] _result The result that will be converted. Its colors must have been gathered.
+		**/
+		void prepare_conversion( const ConversionResult& _result );
+
+		/**
+		* @brief Check that splitting the conversion between several threads gives the same result as a single thread, for each palette and each distance.
+		* A fixed image is gathered, converted and its pixels counted once in a single band and once in several, each difference is logged.
+		* The application doesn't run it, it is only done when started with the --check-conversion argument.
+		* @return True if both ways gave the same distinct colors, pixel colors, palette indices and color counts.
+		**/
+		bool check_parallel_conversion();
 
 		/**
 		* @brief Copy the base palettes from the application datas to the My Documents directory, overriding them in the process.
@@ -45,10 +76,22 @@ namespace Pixeler
 		void reset_base_palettes();
 		
 		/**
-		* @brief Set all colors counts of the current palette to 0. Called when beginning a new image convertion.
-		* @param _all_palettes True if the color counts of all the palettes are reset. Juste the selected one otherwise.
+		* @brief Replace the conversion result displayed in the colors list. The result is swapped atomically, so it can be given by any thread.
+		* @param [in] _result The new result, nullptr to remove the current one.
+		**/
+		void set_conversion_result( std::shared_ptr< const ConversionResult > _result );
+
+		/**
+		* @brief Get the conversion result displayed in the colors list. The returned pointer keeps the result alive even if it is replaced meanwhile.
 		**/
-		void reset_color_counts( bool _all_palettes );
+		std::shared_ptr< const ConversionResult > get_conversion_result() const { return m_conversion_result.load(); }
+
+		/**
+		* @brief Get the number of pixels converted to the given color in the current conversion result.
+		* @param [in] _color The color to look for.
+		* @return The number of pixels using the color, 0 if it wasn't used or isn't part of the converted palette, -1 if there is no conversion.
+		**/
+		int get_color_count( const ColorInfos& _color ) const;
 
 		/**
 		* @brief Check if there has been an image convertion.
@@ -62,6 +105,13 @@ namespace Pixeler
 		**/
 		const ColorPalette* get_selected_palette() const;
 
+		/**
+		* @brief Look for a palette by name. The conversions keep the name of their palette, as its address changes when palettes are added or removed.
+		* @param [in] _palette The name of the palette to find.
+		* @return A pointer to the palette if found, nullptr otherwise. Only valid until the palette list changes.
+		**/
+		const ColorPalette* get_palette( std::string_view _palette ) const;
+
 	private:
 		/************************************************************************
 		* @brief All the needed informations for palette creation.
@@ -84,6 +134,16 @@ namespace Pixeler
 			ColorPreset* m_source_preset{ nullptr };			// When creating a preset from an other one, its infos will be needed when confirming the creation.
 			bool m_create_from_current_selection{ false };		// When saving as, the new preset will be created from the current selection of colors.
 		};
+		/************************************************************************
+		* @brief The conversion displayed on the canvas while a palette color is edited, updated each time the color changes without converting the whole image again.
+		************************************************************************/
+		struct EditedColorPreview
+		{
+			std::shared_ptr< const ConversionResult >	m_base_result;			// The conversion displayed before the edition, restored if it is cancelled.
+			std::shared_ptr< ConversionResult >			m_result;				// The conversion using the edited color instead of the palette one.
+			std::vector< ImVec4 >						m_coordinates;			// The coordinates of the distinct colors of the image, for the distance of the conversion.
+			std::vector< uint8_t >						m_changed_colors;		// The distinct colors whose pixels changed since the beginning of the edition.
+		};
 
 		/************************************************************************
 		* PALETTE FUNCTIONS
@@ -211,6 +271,26 @@ namespace Pixeler
 		**/
 		void _reset_color_to_edit();
 
+		/**
+		* @brief Display the edited color on the canvas as if it was already applied to the palette. Only the pixels whose palette color changes are updated.
+		**/
+		void _preview_edited_color();
+
+		/**
+		* @brief Give back their palette colors to the pixels modified by the preview of the edited color.
+		**/
+		void _cancel_edited_color_preview();
+
+		/**
+		* @brief Update a conversion after one of its palette colors changed, by only looking for a new palette color for the distinct colors that were using it or that are closer to its new value.
+		* @param [in,out]	_result			The result to update. It must have been converted with the current selection of the selected palette.
+		* @param [in]		_palette_index	The index of the edited color in the palette colors vector. It must be selected.
+		* @param [in]		_new_color		The new value of the edited color.
+		* @param [in]		_coordinates	The coordinates of the distinct colors of the result, for the distance of its conversion.
+		* @return The distinct colors whose pixels have to be displayed again: the ones given another palette color and the ones using the edited color.
+		**/
+		std::vector< uint32_t > _convert_edited_color( ConversionResult& _result, uint16_t _palette_index, const ColorInfos& _new_color, std::span< const ImVec4 > _coordinates ) const;
+
 		/**
 		* @brief Generate a string listing all the presets using a given color.
 		* @param [in] _color_id The ID that will be looked up for presets in the current palette.
@@ -257,6 +337,54 @@ namespace Pixeler
 		**/
 		bool _match_filter( const ColorInfos& _color );
 
+		/**
+		* @brief Find the closest selected color to the given one by comparing it with all the colors of the current palette.
+		* @param [in] _color		The color to look for.
+		* @param [in] _distance	The distance used to compare the colors.
+		* @return A pointer to the closest color, nullptr if there is no selected color.
+		**/
+		ColorInfos* _find_closest_color( const sf::Color& _color, ColorDistance _distance ) const;
+
+		/**
+		* @brief Find the closest selected color to the given one with the fastest structure available for the given distance. Doesn't modify the palette so it can be called from several threads.
+		* @param [in] _color		The color to look for.
+		* @param [in] _distance	The distance used to compare the colors.
+		* @return The index of the closest color in the palette colors vector, Invalid_Index if there is no selected color.
+		**/
+		uint16_t _find_color_index( const sf::Color& _color, ColorDistance _distance ) const;
+
+		/**
+		* @brief Check if the palette candidates of the distinct colors of a result have to be ranked before converting it.
+		* They are only ranked once the selection changes: the result has already been converted with the same palette colors and distance, but isn't up to date anymore.
+		* The first conversion of an image searches the selected colors with the lookup table, the k-d tree or the snapshot instead.
+		* @param [in] _result		The result that will be converted.
+		* @param [in] _distance	The distance used for the conversion.
+		**/
+		bool _needs_candidates( const ConversionResult& _result, ColorDistance _distance ) const;
+
+		/**
+		* @brief Find the closest selected color of each of the given colors with the fastest structure available, splitting big lists between several threads.
+		* @param [in]	_colors				The colors to convert.
+		* @param [out]	_palette_indices	The index in the palette colors vector of the closest color to each color, Invalid_Index if no color is selected. Must be as big as _colors.
+		* @param [in]	_distance			The distance used to compare the colors.
+		* @param [in]	_nb_tasks			The number of threads the colors are split between, 0 to choose it from the number of colors.
+		**/
+		void _find_palette_indices( std::span< const sf::Color > _colors, std::span< uint16_t > _palette_indices, ColorDistance _distance, size_t _nb_tasks = 0 ) const;
+
+		/**
+		* @brief Count the number of pixels converted to each palette color. Big lists are split between several threads, each one counting on its own before all the counts are added together.
+		* @param [in]	_palette_indices	The index in the palette colors vector of each converted color.
+		* @param [in]	_nb_pixels			The number of pixels having each converted color. Must be as big as _palette_indices.
+		* @param [out]	_color_counts		The number of pixels converted to each color of the palette.
+		* @param [in]	_nb_tasks			The number of threads the colors are split between, 0 to choose it from the number of colors.
+		**/
+		void _count_pixels( std::span< const uint16_t > _palette_indices, std::span< const int > _nb_pixels, std::span< int > _color_counts, size_t _nb_tasks = 0 ) const;
+
+		/**
+		* @brief Get the distance chosen in the options to compare colors.
+		**/
+		ColorDistance _get_color_distance() const;
+
 		/************************************************************************
 		* IMGUI
 		************************************************************************/
@@ -340,9 +468,16 @@ namespace Pixeler
 		bool				m_only_used_colors_display{ false };	// Indicate if we are hiding the colors that aren't used in the current image convertion.
 		ColorInfos*			m_color_to_edit{ nullptr };				// A pointer to the color we're editing, nullptr when adding a new color
 		ColorInfos			m_edited_color;							// An edited version of the color submitted for edition, or the new created color.
+		EditedColorPreview	m_edited_color_preview;					// The conversion displayed on the canvas while the color is edited.
 		std::string			m_color_filter{};						// The user entered filter on color name or ID.
 		NewPaletteInfos		m_new_palette_infos;					// Informations needed for palette creation.
 		NewPresetInfos		m_new_preset_infos;						// Informations needed for preset creation.
 		float				m_ID_column_width{ 0.f };				// The width in pixels of the color ID (number) in the color list table. Calculated on palette change.
+		PaletteLookupTable	m_lookup_table;							// Closest colors of the selected palette for all RGB values, rebuilt when the palette or its selection change.
+		PaletteKDTree		m_color_tree;							// Selected colors of the selected palette sorted in a k-d tree, only built for big selections when the lookup table isn't worth building.
+		PaletteSnapshot		m_palette_snapshot;						// Packed copy of the selected colors of the selected palette, used to convert several colors at once when the lookup table isn't worth building.
+		PaletteSnapshot		m_palette_colors_snapshot;				// Packed copy of all the colors of the selected palette, used to rank them for each distinct color of the image.
+
+		std::atomic< std::shared_ptr< const ConversionResult > > m_conversion_result;	// The conversion whose counts are displayed in the colors list.
 	};
 } // namespace Pixeler
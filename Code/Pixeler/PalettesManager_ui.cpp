@@ -471,7 +471,9 @@ namespace Pixeler
 	**/
 	bool PalettesManager::_selectable_color_info( ColorInfos& _color, int _current_row )
 	{
-		if( _match_filter( _color ) == false || m_only_used_colors_display && _color.m_count == 0 )
+		const int color_count{ get_color_count( _color ) };
+
+		if( _match_filter( _color ) == false || m_only_used_colors_display && color_count == 0 )
 			return false;
 
 		int current_column{ 0 };
@@ -555,12 +557,12 @@ namespace Pixeler
 			ImGui::BeginTooltip();
 			Utils::color_infos_tooltip_common( _color );
 
-			if( _color.m_count >= 0 )
+			if( color_count >= 0 )
 			{
 				ImGui::Separator();
 				ImGui::Text( "Total count:" );
 				ImGui::SameLine();
-				ImGui_fzn::bold_text( "%d", _color.m_count );
+				ImGui_fzn::bold_text( "%d", color_count );
 			}
 			ImGui::Separator();
 			if( m_palette_edition )
@@ -579,7 +581,7 @@ namespace Pixeler
 			if( _color.m_color_id.m_id >= 0 )
 			{
 				ImGui::AlignTextToFramePadding();
-				Utils::text_with_leading_zeros( Utils::get_zero_lead_id( _color.m_color_id.m_id ).c_str(), row_hovered, _color.m_count != 0, row_hovered );
+				Utils::text_with_leading_zeros( Utils::get_zero_lead_id( _color.m_color_id.m_id ).c_str(), row_hovered, color_count != 0, row_hovered );
 			}
 		}
 
@@ -589,14 +591,14 @@ namespace Pixeler
 			ImGui::TableSetColumnIndex( current_column++ );
 			ImGui::AlignTextToFramePadding();
 
-			Utils::boldable_text( _color.m_color_id.m_name, row_hovered, _color.m_count != 0, row_hovered );
+			Utils::boldable_text( _color.m_color_id.m_name, row_hovered, color_count != 0, row_hovered );
 		}
 
 		//////////////////////////////////////// COUNT ////////////////////////////////////////
 		if( has_convertion_happened() )
 		{
 			ImGui::TableSetColumnIndex( current_column++ );
-			Utils::boldable_text( fzn::Tools::Sprintf( "%d", _color.m_count ), row_hovered, true, row_hovered );
+			Utils::boldable_text( fzn::Tools::Sprintf( "%d", color_count ), row_hovered, true, row_hovered );
 		}
 
 		//////////////////////////////////////// MISC ////////////////////////////////////////
@@ -621,7 +623,7 @@ namespace Pixeler
 		ImGui::PopID();
 
 		// Outline the color if used in the convertion
-		if( _color.m_count > 0 && row_hovered )
+		if( color_count > 0 && row_hovered )
 			g_pixeler->get_canvas_manager().compute_pixel_area( _color );
 
 		return true;
@@ -677,7 +679,11 @@ namespace Pixeler
 
 			ImGui::Spacing();
 			ImGui::SetNextItemWidth( widget_with );
-			ImGui::ColorPicker4( "##color", &m_edited_color.m_color.Value.x, ImGuiColorEditFlags_NoAlpha, m_color_to_edit != nullptr ? &m_color_to_edit->m_color.Value.x : nullptr );
+			if( ImGui::ColorPicker4( "##color", &m_edited_color.m_color.Value.x, ImGuiColorEditFlags_NoAlpha, m_color_to_edit != nullptr ? &m_color_to_edit->m_color.Value.x : nullptr ) )
+			{
+				m_edited_color.update_color_spaces();
+				_preview_edited_color();
+			}
 
 			if( m_color_to_edit != nullptr )
 				_edit_color_buttons();
@@ -710,7 +716,10 @@ namespace Pixeler
 			ImGui::TableSetColumnIndex( 2 );
 			// Cancel the edit and go back to the color list.
 			if( ImGui::Button( "Cancel", DefaultWidgetSize ) )
+			{
+				_cancel_edited_color_preview();
 				_reset_color_to_edit();
+			}
 		} );
 	}
 
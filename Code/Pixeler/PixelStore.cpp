@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "PixelStore.h"
+#include "Utils.h"
+
+#if defined( _M_X64 ) || defined( __SSE2__ )
+	#define PIXELER_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define PIXELER_SSE2 0
+#endif
+
+
+namespace Pixeler
+{
+	static constexpr size_t Min_Pixels_Per_Task{ 65536 };		// Below this number of pixels, filling the planes on another thread costs more than it saves.
+	static constexpr size_t Words_Per_Stop_Check{ 1024 };		// The number of opaque mask words filled between two checks of the stop token.
+
+	static_assert( sizeof( sf::Color ) == ColorChannel::COUNT, "The base colors are copied straight from red, green, blue and alpha bytes." );
+
+	/**
+	* @brief Build the opaque mask bits of consecutive pixels.
+	* SSE2 is always available on x64: the alpha bytes of 16 pixels are gathered in one register and compared at once, the remaining pixels are tested one by one.
+	* @param [in] _colors		The colors of the first pixel.
+	* @param [in] _nb_pixels	The number of pixels, 64 at most.
+	* @return One bit per pixel, starting from the lowest one, set for the opaque pixels.
+	**/
+	static uint64_t get_opaque_bits( const sf::Color* _colors, size_t _nb_pixels )
+	{
+		uint64_t bits{ 0 };
+		size_t pixel{ 0 };
+
+#if PIXELER_SSE2
+		// SSE2 only compares signed bytes, flipping their highest bit gives the same order as comparing them unsigned.
+		const __m128i sign_bit{ _mm_set1_epi8( static_cast< char >( 0x80 ) ) };
+		const __m128i min_alpha{ _mm_set1_epi8( static_cast< char >( Min_Pixel_Alpha ^ 0x80 ) ) };
+
+		for( ; pixel + 16 <= _nb_pixels; pixel += 16 )
+		{
+			const __m128i* colors{ reinterpret_cast< const __m128i* >( _colors + pixel ) };
+
+			// Alpha is the highest byte of each pixel, shifting it down and packing the pixels twice leaves the 16 alpha values in order.
+			const __m128i alphas_0_7{ _mm_packs_epi32( _mm_srli_epi32( _mm_loadu_si128( colors ), 24 ), _mm_srli_epi32( _mm_loadu_si128( colors + 1 ), 24 ) ) };
+			const __m128i alphas_8_15{ _mm_packs_epi32( _mm_srli_epi32( _mm_loadu_si128( colors + 2 ), 24 ), _mm_srli_epi32( _mm_loadu_si128( colors + 3 ), 24 ) ) };
+			const __m128i alphas{ _mm_xor_si128( _mm_packus_epi16( alphas_0_7, alphas_8_15 ), sign_bit ) };
+			const uint32_t transparent_bits{ static_cast< uint32_t >( _mm_movemask_epi8( _mm_cmplt_epi8( alphas, min_alpha ) ) ) };
+
+			bits |= uint64_t{ ~transparent_bits & 0xFFFF } << pixel;
+		}
+#endif
+
+		for( ; pixel < _nb_pixels; ++pixel )
+			bits |= uint64_t{ _colors[ pixel ].a >= Min_Pixel_Alpha } << pixel;
+
+		return bits;
+	}
+
+	/**
+	* @brief Fill the planes from the given pixels. The palette indices are all invalid until a conversion is applied.
+	* @param [in] _size		The size of the image.
+	* @param [in] _pixels		The red, green, blue and alpha values of all the pixels of the image, row by row.
+	* @param [in] _stop_token	The token of the loading thread. If it asks to stop, the store is left empty.
+	**/
+	void PixelStore::create( const sf::Vector2u& _size, const uint8_t* _pixels, std::stop_token _stop_token /*= {}*/ )
+	{
+		if( _pixels == nullptr )
+		{
+			clear();
+			return;
+		}
+
+		create( _size );
+
+		const size_t nb_pixels{ m_base_colors.size() };
+		const size_t nb_tasks{ std::min( Utils::get_nb_tasks( nb_pixels, Min_Pixels_Per_Task ), m_opaque_mask.size() ) };
+		std::vector< size_t > tasks_nb_opaque_pixels( nb_tasks, 0 );
+
+		// Each task fills whole words of the opaque mask, so no word is shared between two of them.
+		// The words are filled by blocks, so a stop request is seen quickly even on huge images.
+		Utils::parallel_for( m_opaque_mask.size(), nb_tasks, [&]( size_t _task, size_t _first_word, size_t _last_word )
+		{
+			for( size_t first_block_word{ _first_word }; first_block_word < _last_word && _stop_token.stop_requested() == false; first_block_word += Words_Per_Stop_Check )
+			{
+				const size_t last_block_word{ std::min( first_block_word + Words_Per_Stop_Check, _last_word ) };
+				const size_t first_pixel{ first_block_word * Bits_Per_Word };
+				const size_t last_pixel{ std::min( last_block_word * Bits_Per_Word, nb_pixels ) };
+
+				std::memcpy( m_base_colors.data() + first_pixel, _pixels + first_pixel * ColorChannel::COUNT, ( last_pixel - first_pixel ) * sizeof( sf::Color ) );
+
+				for( size_t word{ first_block_word }; word < last_block_word; ++word )
+				{
+					const size_t word_first_pixel{ word * Bits_Per_Word };
+
+					m_opaque_mask[ word ] = get_opaque_bits( &m_base_colors[ word_first_pixel ], std::min( Bits_Per_Word, nb_pixels - word_first_pixel ) );
+					tasks_nb_opaque_pixels[ _task ] += std::popcount( m_opaque_mask[ word ] );
+				}
+			}
+		} );
+
+		if( _stop_token.stop_requested() )
+		{
+			clear();
+			return;
+		}
+
+		for( const size_t task_nb_opaque_pixels : tasks_nb_opaque_pixels )
+			m_nb_opaque_pixels += task_nb_opaque_pixels;
+	}
+
+	/**
+	* @brief Allocate the planes for an image of the given size, with all its pixels transparent until their row is set.
+	* @param [in] _size The size of the image.
+	**/
+	void PixelStore::create( const sf::Vector2u& _size )
+	{
+		clear();
+
+		const size_t nb_pixels{ static_cast< size_t >( _size.x ) * _size.y };
+
+		m_size = _size;
+		m_base_colors.assign( nb_pixels, sf::Color::Transparent );
+		m_palette_indices.assign( nb_pixels, Invalid_Index );
+		m_opaque_mask.assign( ( nb_pixels + Bits_Per_Word - 1 ) / Bits_Per_Word, 0 );
+	}
+
+	/**
+	* @brief Set the base colors of the pixels of a row, so an image can be decoded row by row straight into the planes.
+	* @param [in] _row		The index of the row, from the top.
+	* @param [in] _colors	The colors of the pixels of the row, as many as the width of the image.
+	**/
+	void PixelStore::set_row( uint32_t _row, std::span< const sf::Color > _colors )
+	{
+		if( _row >= m_size.y || _colors.size() < m_size.x )
+			return;
+
+		const size_t first_pixel{ static_cast< size_t >( _row ) * m_size.x };
+		const size_t last_pixel{ first_pixel + m_size.x };
+
+		std::memcpy( m_base_colors.data() + first_pixel, _colors.data(), m_size.x * sizeof( sf::Color ) );
+
+		// The row is classified one mask word at a time, its first and last words can be shared with the rows around it.
+		for( size_t pixel{ first_pixel }; pixel < last_pixel; )
+		{
+			uint64_t& mask_word{ m_opaque_mask[ pixel / Bits_Per_Word ] };
+			const size_t first_bit{ pixel % Bits_Per_Word };
+			const size_t nb_pixels{ std::min( Bits_Per_Word - first_bit, last_pixel - pixel ) };
+			const uint64_t row_bits{ ( nb_pixels == Bits_Per_Word ? ~uint64_t{ 0 } : ( uint64_t{ 1 } << nb_pixels ) - 1 ) << first_bit };
+			const uint64_t opaque_bits{ get_opaque_bits( &m_base_colors[ pixel ], nb_pixels ) << first_bit };
+
+			m_nb_opaque_pixels += std::popcount( opaque_bits );
+			m_nb_opaque_pixels -= std::popcount( mask_word & row_bits );
+			mask_word = ( mask_word & ~row_bits ) | opaque_bits;
+
+			pixel += nb_pixels;
+		}
+	}
+
+	/**
+	* @brief Remove all the pixels.
+	**/
+	void PixelStore::clear()
+	{
+		m_base_colors.clear();
+		m_palette_indices.clear();
+		m_opaque_mask.clear();
+		m_size = { 0, 0 };
+		m_nb_opaque_pixels = 0;
+	}
+
+	/**
+	* @brief Find the smallest rectangle containing all the opaque pixels, reading the opaque mask 64 pixels at a time.
+	* @param [in] _stop_token The token of the loading thread. If it asks to stop, the remaining rows are skipped and the rectangle is meaningless.
+	* @return The rectangle in image space, the whole image if no pixel is opaque.
+	**/
+	sf::FloatRect PixelStore::compute_opaque_rect( std::stop_token _stop_token /*= {}*/ ) const
+	{
+		struct Bounds
+		{
+			size_t m_left{ Uint32_Max };
+			size_t m_top{ Uint32_Max };
+			size_t m_right{ 0 };							// The column following the last opaque pixel.
+			size_t m_bottom{ 0 };							// The row following the last opaque pixel.
+		};
+
+		const size_t nb_tasks{ std::min< size_t >( Utils::get_nb_tasks( get_nb_pixels(), Min_Pixels_Per_Task ), m_size.y ) };
+		std::vector< Bounds > tasks_bounds( nb_tasks );
+
+		// Each task looks for the opaque pixels of a band of rows, the bounds of the bands are merged afterwards.
+		Utils::parallel_for( m_size.y, nb_tasks, [&]( size_t _task, size_t _first_row, size_t _last_row )
+		{
+			Bounds& bounds{ tasks_bounds[ _task ] };
+
+			for( size_t row{ _first_row }; row < _last_row && _stop_token.stop_requested() == false; ++row )
+			{
+				const size_t first_pixel{ row * m_size.x };
+				const size_t last_pixel{ first_pixel + m_size.x };
+				const size_t first_opaque_pixel{ _find_first_opaque_pixel( first_pixel, last_pixel ) };
+
+				if( first_opaque_pixel == last_pixel )
+					continue;
+
+				bounds.m_left = std::min( bounds.m_left, first_opaque_pixel - first_pixel );
+				bounds.m_right = std::max( bounds.m_right, _find_last_opaque_pixel( first_pixel, last_pixel ) - first_pixel + 1 );
+				bounds.m_top = std::min( bounds.m_top, row );
+				bounds.m_bottom = row + 1;
+			}
+		} );
+
+		Bounds image_bounds;
+
+		for( const Bounds& bounds : tasks_bounds )
+		{
+			image_bounds.m_left = std::min( image_bounds.m_left, bounds.m_left );
+			image_bounds.m_top = std::min( image_bounds.m_top, bounds.m_top );
+			image_bounds.m_right = std::max( image_bounds.m_right, bounds.m_right );
+			image_bounds.m_bottom = std::max( image_bounds.m_bottom, bounds.m_bottom );
+		}
+
+		if( image_bounds.m_right == 0 )
+			return { 0.f, 0.f, static_cast< float >( m_size.x ), static_cast< float >( m_size.y ) };
+
+		return { static_cast< float >( image_bounds.m_left ), static_cast< float >( image_bounds.m_top ), static_cast< float >( image_bounds.m_right - image_bounds.m_left ), static_cast< float >( image_bounds.m_bottom - image_bounds.m_top ) };
+	}
+
+	/**
+	* @brief Forget the palette colors of all the pixels, keeping their base colors.
+	**/
+	void PixelStore::clear_palette_indices()
+	{
+		std::ranges::fill( m_palette_indices, Invalid_Index );
+	}
+
+	/**
+	* @brief Find the first opaque pixel of a range of pixels.
+	* @param [in] _first_pixel	The first pixel of the range.
+	* @param [in] _last_pixel	The pixel following the range.
+	* @return The index of the first opaque pixel, _last_pixel if there is none.
+	**/
+	size_t PixelStore::_find_first_opaque_pixel( size_t _first_pixel, size_t _last_pixel ) const
+	{
+		for( size_t pixel{ _first_pixel }; pixel < _last_pixel; )
+		{
+			const size_t first_bit{ pixel % Bits_Per_Word };
+			const uint64_t opaque_bits{ m_opaque_mask[ pixel / Bits_Per_Word ] >> first_bit };
+
+			// The bits of the word can go past the range, in which case there is no opaque pixel in it.
+			if( opaque_bits != 0 )
+				return std::min( pixel + std::countr_zero( opaque_bits ), _last_pixel );
+
+			pixel += Bits_Per_Word - first_bit;
+		}
+
+		return _last_pixel;
+	}
+
+	/**
+	* @brief Find the last opaque pixel of a range of pixels which has at least one.
+	* @param [in] _first_pixel	The first pixel of the range.
+	* @param [in] _last_pixel	The pixel following the range.
+	* @return The index of the last opaque pixel.
+	**/
+	size_t PixelStore::_find_last_opaque_pixel( size_t _first_pixel, size_t _last_pixel ) const
+	{
+		for( size_t pixel{ _last_pixel - 1 }; pixel >= _first_pixel; )
+		{
+			const size_t last_bit{ pixel % Bits_Per_Word };
+			const uint64_t opaque_bits{ m_opaque_mask[ pixel / Bits_Per_Word ] << ( Bits_Per_Word - 1 - last_bit ) };
+
+			if( opaque_bits != 0 )
+				return pixel - std::countl_zero( opaque_bits );
+
+			if( pixel < last_bit + 1 )
+				break;
+
+			pixel -= last_bit + 1;
+		}
+
+		return _first_pixel;
+	}
+} // namespace Pixeler
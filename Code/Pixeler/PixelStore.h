@@ -0,0 +1,114 @@
+#pragma once
+
+#include <limits>
+#include <span>
+#include <stop_token>
+#include <vector>
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include "Defines.h"
+
+
+namespace Pixeler
+{
+	/************************************************************************
+	* @brief The pixels of the loaded image, stored plane by plane: the base color of each pixel, the palette color it has been converted to and whether it is opaque.
+	* The palette index plane is the converted image: the canvas tiles and the hovered areas are derived from it.
+	* The position of a pixel is its index in the planes, so it isn't stored.
+	* Scanning one plane only reads the information it needs, a few bytes per pixel at most.
+	************************************************************************/
+	class PixelStore
+	{
+	public:
+		static constexpr uint16_t Invalid_Index{ std::numeric_limits< uint16_t >::max() };	// The pixel is transparent or hasn't been converted.
+
+		/**
+		* @brief Fill the planes from the given pixels. The palette indices are all invalid until a conversion is applied.
+		* @param [in] _size		The size of the image.
+		* @param [in] _pixels		The red, green, blue and alpha values of all the pixels of the image, row by row.
+		* @param [in] _stop_token	The token of the loading thread. If it asks to stop, the store is left empty.
+		**/
+		void create( const sf::Vector2u& _size, const uint8_t* _pixels, std::stop_token _stop_token = {} );
+
+		/**
+		* @brief Allocate the planes for an image of the given size, with all its pixels transparent until their row is set.
+		* @param [in] _size The size of the image.
+		**/
+		void create( const sf::Vector2u& _size );
+
+		/**
+		* @brief Set the base colors of the pixels of a row, so an image can be decoded row by row straight into the planes.
+		* @param [in] _row		The index of the row, from the top.
+		* @param [in] _colors	The colors of the pixels of the row, as many as the width of the image.
+		**/
+		void set_row( uint32_t _row, std::span< const sf::Color > _colors );
+
+		/**
+		* @brief Remove all the pixels.
+		**/
+		void clear();
+
+		/**
+		* @brief Find the smallest rectangle containing all the opaque pixels, reading the opaque mask 64 pixels at a time.
+		* @param [in] _stop_token The token of the loading thread. If it asks to stop, the remaining rows are skipped and the rectangle is meaningless.
+		* @return The rectangle in image space, the whole image if no pixel is opaque.
+		**/
+		sf::FloatRect compute_opaque_rect( std::stop_token _stop_token = {} ) const;
+
+		/**
+		* @brief Forget the palette colors of all the pixels, keeping their base colors.
+		**/
+		void clear_palette_indices();
+
+		const sf::Vector2u&				get_size() const { return m_size; }
+		size_t							get_nb_pixels() const { return m_base_colors.size(); }
+		size_t							get_nb_opaque_pixels() const { return m_nb_opaque_pixels; }
+		std::span< const sf::Color >	get_base_colors() const { return m_base_colors; }
+		std::span< const uint16_t >		get_palette_indices() const { return m_palette_indices; }
+		std::span< uint16_t >			get_palette_indices() { return m_palette_indices; }
+
+		const sf::Color&	get_base_color( size_t _pixel ) const { return m_base_colors[ _pixel ]; }
+		uint16_t			get_palette_index( size_t _pixel ) const { return m_palette_indices[ _pixel ]; }
+
+		/**
+		* @brief Set the palette color of a pixel. Different pixels can be set from different threads.
+		* @param [in] _pixel			The index of the pixel in the image, transparent pixels included.
+		* @param [in] _palette_index	The index of its color in the palette colors vector, Invalid_Index if it has none.
+		**/
+		void set_palette_index( size_t _pixel, uint16_t _palette_index ) { m_palette_indices[ _pixel ] = _palette_index; }
+
+		/**
+		* @brief Check if a pixel is opaque enough to be displayed and converted.
+		* @param [in] _pixel The index of the pixel in the image, transparent pixels included.
+		**/
+		bool is_opaque( size_t _pixel ) const { return ( m_opaque_mask[ _pixel / Bits_Per_Word ] >> ( _pixel % Bits_Per_Word ) & 1 ) != 0; }
+
+	private:
+		static constexpr size_t Bits_Per_Word{ 64 };
+
+		/**
+		* @brief Find the first opaque pixel of a range of pixels.
+		* @param [in] _first_pixel	The first pixel of the range.
+		* @param [in] _last_pixel	The pixel following the range.
+		* @return The index of the first opaque pixel, _last_pixel if there is none.
+		**/
+		size_t _find_first_opaque_pixel( size_t _first_pixel, size_t _last_pixel ) const;
+
+		/**
+		* @brief Find the last opaque pixel of a range of pixels which has at least one.
+		* @param [in] _first_pixel	The first pixel of the range.
+		* @param [in] _last_pixel	The pixel following the range.
+		* @return The index of the last opaque pixel.
+		**/
+		size_t _find_last_opaque_pixel( size_t _first_pixel, size_t _last_pixel ) const;
+
+		std::vector< sf::Color >	m_base_colors;							// The color of each pixel before the conversion, 4 bytes per pixel.
+		std::vector< uint16_t >		m_palette_indices;						// The index in the palette colors vector of the new color of each pixel, Invalid_Index if it has none.
+		std::vector< uint64_t >		m_opaque_mask;							// One bit per pixel, set for the opaque ones.
+		sf::Vector2u				m_size{ 0, 0 };							// The size of the image.
+		size_t						m_nb_opaque_pixels{ 0 };				// The number of pixels displayed on the canvas.
+	};
+} // namespace Pixeler
@@ -85,7 +85,7 @@ namespace Pixeler
 		GetOpenFileName( &open_file_name );
 
 		if( open_file_name.lpstrFile[ 0 ] != '\0' )
-			m_canvas_manager.load_texture( open_file_name.lpstrFile );
+			m_canvas_manager.load_image( open_file_name.lpstrFile );
 	}
 
 	void CPixeler::_display_menu_bar()
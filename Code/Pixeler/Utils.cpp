@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <thread>
+
 #include <SFML/Graphics/Color.hpp>
 
 #include <FZN/UI/ImGui.h>
@@ -167,5 +170,30 @@ namespace Pixeler::Utils
 			ImGui::EndTable();
 		}
 	}
+
+	size_t get_nb_tasks( size_t _nb_items, size_t _min_items_per_task )
+	{
+		const size_t nb_threads{ std::max< size_t >( std::thread::hardware_concurrency(), 1 ) };
+
+		return std::clamp< size_t >( _nb_items / std::max< size_t >( _min_items_per_task, 1 ), 1, nb_threads );
+	}
+
+	void parallel_for( size_t _nb_items, size_t _nb_tasks, const std::function<void( size_t, size_t, size_t )>& _task_fct )
+	{
+		if( _nb_tasks <= 1 )
+		{
+			_task_fct( 0, 0, _nb_items );
+			return;
+		}
+
+		// The threads join when they are destroyed at the end of the function.
+		std::vector< std::jthread > threads;
+		threads.reserve( _nb_tasks - 1 );
+
+		for( size_t task{ 1 }; task < _nb_tasks; ++task )
+			threads.emplace_back( _task_fct, task, _nb_items * task / _nb_tasks, _nb_items * ( task + 1 ) / _nb_tasks );
+
+		_task_fct( 0, 0, _nb_items / _nb_tasks );
+	}
 } // namespace Pixeler
 
@@ -34,5 +34,16 @@ namespace Pixeler
 		void color_infos_tooltip_common( const ColorInfos& _color );
 
 		void window_bottom_table( uint8_t _nb_items, std::function<void(void)> _table_content_fct );
+
+		//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+		// Get the number of tasks to split a work of _nb_items between, one per core at most and with at least _min_items_per_task items in each task.
+		//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+		size_t get_nb_tasks( size_t _nb_items, size_t _min_items_per_task );
+
+		//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+		// Split _nb_items in _nb_tasks contiguous ranges and call _task_fct( task, first_item, last_item ) on each of them, each one on its own thread.
+		// The first range is handled by the calling thread and the function returns once all the ranges are done.
+		//------------------------------------------------------------------------------------------------------------------------------------------------------------------
+		void parallel_for( size_t _nb_items, size_t _nb_tasks, const std::function<void( size_t, size_t, size_t )>& _task_fct );
 	} // namespace Utils
 } // namespace Pixeler
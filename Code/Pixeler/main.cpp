@@ -4,6 +4,9 @@
 //Description : Entry point of the program
 //------------------------------------------------------------------------
 
+#include <cstdlib>
+#include <string_view>
+
 #include <FZN/Includes.h>
 #include <FZN/Managers/DataManager.h>
 #include <FZN/Managers/WindowManager.h>
@@ -12,7 +15,7 @@
 
 #include "Pixeler.h"
 
-int main()
+int main( int argc, char* argv[] )
 {
 	fzn::FazonCore::ProjectDesc desc{ "Pixeler", FZNProjectType::Application };
 	fzn::Tools::MaskRaiseFlag( desc.m_uModules, fzn::FazonCore::CoreModuleFlags_InputModule );
@@ -38,6 +41,10 @@ int main()
 
 	auto perler_maker = Pixeler::CPixeler{};
 
+	//Only checking that the conversion gives the same results on one or several threads, without running the application
+	if( argc > 1 && std::string_view{ argv[ 1 ] } == "--check-conversion" )
+		return perler_maker.get_palettes_manager().check_parallel_conversion() ? EXIT_SUCCESS : EXIT_FAILURE;
+
 	//Game loop (add callbacks to your functions so they can be called in there)
 	g_pFZN_Core->GameLoop();
 }